@@ -0,0 +1,112 @@
+#ifndef CAPACITY_POLICY_H
+#define CAPACITY_POLICY_H
+
+#include <cstdint>
+#include <cstddef>
+
+namespace
+{
+
+    // Internal method to test if a positive number is prime.
+    bool IsPrime(size_t n)
+    {
+        if (n == 2 || n == 3)
+            return true;
+
+        if (n == 1 || n % 2 == 0)
+            return false;
+
+        for (size_t i = 3; i * i <= n; i += 2)
+            if (n % i == 0)
+                return false;
+
+        return true;
+    }
+
+    // Internal method to return a prime number at least as large as n.
+    int NextPrime(size_t n)
+    {
+        if (n % 2 == 0)
+            ++n;
+        while (!IsPrime(n))
+            n += 2;
+        return n;
+    }
+
+} // namespace
+
+/*
+ * Capacity policies for the probing tables (linear, quadratic, double).
+ * A table takes one as its second template argument; it picks the table
+ * sizes and turns a hash into a slot and a probe into the next slot.
+ *  - PrimeCapacity, the default: prime sizes and hf(x) % size, as in the
+ *    textbook. Every lookup pays an integer division.
+ *  - PowerOfTwoCapacity: power-of-two sizes. The hash is mixed by a
+ *    Fibonacci multiply (so keys that differ only in high bits still spread)
+ *    and then masked, and probes wrap with the same mask.
+ * Quadratic probing steps its offset by kQuadraticStep. With 2 the offsets
+ * are 1, 3, 5, ... and the probes land on i^2, which reaches half of a prime
+ * table. Under power-of-two sizes i^2 can cycle early, so the offsets become
+ * 1, 2, 3, ... and the probes land on the triangular numbers i(i + 1)/2,
+ * which reach every slot. Double hashing needs a step coprime to the size,
+ * so under power-of-two sizes DoubleStep makes it odd.
+ */
+struct PrimeCapacity
+{
+    static const size_t kQuadraticStep = 2;
+
+    static size_t Capacity(size_t n)
+    {
+        return NextPrime(n);
+    }
+
+    static size_t Index(size_t hash, size_t capacity)
+    {
+        return hash % capacity;
+    }
+
+    // pos and offset are both below capacity.
+    static size_t Next(size_t pos, size_t offset, size_t capacity)
+    {
+        pos += offset;
+        if (pos >= capacity)
+            pos -= capacity;
+        return pos;
+    }
+
+    static size_t DoubleStep(size_t step)
+    {
+        return step;
+    }
+};
+
+struct PowerOfTwoCapacity
+{
+    static const size_t kQuadraticStep = 1;
+
+    static size_t Capacity(size_t n)
+    {
+        size_t capacity = 1;
+        while (capacity < n)
+            capacity *= 2;
+        return capacity;
+    }
+
+    static size_t Index(size_t hash, size_t capacity)
+    {
+        uint64_t h = static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(h ^ (h >> 32)) & (capacity - 1);
+    }
+
+    static size_t Next(size_t pos, size_t offset, size_t capacity)
+    {
+        return (pos + offset) & (capacity - 1);
+    }
+
+    static size_t DoubleStep(size_t step)
+    {
+        return step | 1;
+    }
+};
+
+#endif // CAPACITY_POLICY_H
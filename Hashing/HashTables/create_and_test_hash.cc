@@ -6,6 +6,7 @@
 #include "quadratic_probing.h"
 #include "linear_probing.h"
 #include "double_hashing.h"
+#include "swiss_table.h"
 
 using namespace std;
 
@@ -62,7 +63,7 @@ void TestFunctionForHashTable(HashTableType &hash_table,
 
 // @argument_count: argc as provided in main
 // @argument_list: argv as provided in imain
-// Calls the specific testing function for hash table (linear, quadratic, or double).
+// Calls the specific testing function for hash table (linear, quadratic, double, or swiss).
 int testHashingWrapper(int argument_count, char **argument_list)
 {
     const string words_filename(argument_list[1]);
@@ -96,10 +97,16 @@ int testHashingWrapper(int argument_count, char **argument_list)
         HashTableDouble<string> double_probing_table(R);
         TestFunctionForHashTable(double_probing_table, words_filename, query_filename);
     }
+    else if (param_flag == "swiss")
+    {
+        HashTableSwiss<string> swiss_table;
+        TestFunctionForHashTable(swiss_table, words_filename, query_filename);
+        cout << "key_compares: " << swiss_table.get_table_data()[3] << endl;
+    }
     else
     {
         cout << "Unknown tree type " << param_flag
-             << " (User should provide linear, quadratic, or double)" << endl;
+             << " (User should provide linear, quadratic, double, or swiss)" << endl;
     }
     return 0;
 }
@@ -5,8 +5,11 @@
 #include <algorithm>
 #include <functional>
 
-// Double Hashing Implementation.
-template <typename HashedObj>
+#include "capacity_policy.h"
+
+// Double Hashing Implementation. CapacityPolicy (capacity_policy.h) picks
+// prime or power-of-two table sizes.
+template <typename HashedObj, typename CapacityPolicy = PrimeCapacity>
 class HashTableDouble
 {
 public:
@@ -23,10 +26,10 @@ public:
      *
      * Details:
      *  - Intializes R with the value of r.
-     *  - Intalizes table's size with the next prime of size.
+     *  - Intalizes table's size with the policy's capacity for size.
      *  - Check if R > table size, if yes, abort operation
      */
-    explicit HashTableDouble(int r, size_t size = 101) : array_(NextPrime(size)), R(r)
+    explicit HashTableDouble(int r, size_t size = 101) : array_(CapacityPolicy::Capacity(size)), R(r)
     {
         if (R > array_.size()){
             std::cerr << "ERROR";
@@ -207,9 +210,8 @@ private:
         while (array_[current_pos].info_ != EMPTY &&
                array_[current_pos].element_ != x)
         {
-            current_pos += offset; // Compute ith probe.
-            if (current_pos >= array_.size())
-                current_pos -= array_.size();
+            // Compute ith probe.
+            current_pos = CapacityPolicy::Next(current_pos, offset, array_.size());
 
             collision_count_++;
             probe_count_++;
@@ -229,7 +231,7 @@ private:
     {
         std::vector<HashEntry> old_array = array_;
         // Create new double-sized, empty table.
-        array_.resize(NextPrime(2 * old_array.size()));
+        array_.resize(CapacityPolicy::Capacity(2 * old_array.size()));
         for (auto &entry : array_)
             entry.info_ = EMPTY;
 
@@ -248,7 +250,7 @@ private:
     size_t InternalHash(const HashedObj &x) const
     {
         static std::hash<HashedObj> hf;
-        return hf(x) % array_.size();
+        return CapacityPolicy::Index(hf(x), array_.size());
     }
 
     /**
@@ -259,7 +261,7 @@ private:
     size_t InternalHash2(const HashedObj &x) const
     {
         static std::hash<HashedObj> hf;
-        return R - (hf(x) % R);
+        return CapacityPolicy::DoubleStep(R - (hf(x) % R));
     }
 };
 
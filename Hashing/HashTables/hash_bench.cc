@@ -0,0 +1,226 @@
+// hash_bench.cc: times the hash tables on a dictionary of words.
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+
+#include "quadratic_probing.h"
+#include "linear_probing.h"
+#include "double_hashing.h"
+#include "swiss_table.h"
+#include "robin_hood.h"
+#include "datagen.h" // Sorts/Complexity Tests, on the Makefile's include path
+
+using namespace std;
+
+const int kRepeats = 5;
+const size_t kIntKeys = 1 << 20;
+const size_t kChurnKeys = 1 << 16;   // live keys during the churn
+const size_t kChurnRounds = 1 << 20; // removes, each followed by an insert
+const int kDoubleR = 89;             // create_and_test_hash's default R
+const int kKeyRange = 1 << 30;       // doubled, so keys stay below INT_MAX
+const uint64_t kSeed = 42;
+
+// @n: how many keys
+// @dist: their distribution, as in the sort benchmarks
+// @keys, @misses: 2x and 2x + 1 of the generated values, so the keys are even
+// and no miss is ever a key.
+void MakeIntKeys(size_t n, Distribution dist, vector<int> &keys, vector<int> &misses)
+{
+    generate(keys, n, kKeyRange, dist, kSeed);
+    misses.resize(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        keys[i] *= 2;
+        misses[i] = keys[i] + 1;
+    }
+}
+
+double MsSince(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// @words: the keys inserted
+// @misses: keys not in the table
+// @args: passed to the table's constructor (R, for double hashing)
+// Inserts every word, then looks up every word and every miss. Prints the
+// best of kRepeats for each, and the mean probes per lookup as Contains
+// reports them.
+template <typename HashTableType, typename Key, typename... Args>
+void BenchHashTable(const string &name, const vector<Key> &words, const vector<Key> &misses, Args... args)
+{
+    double insert_ms = 1e300, hit_ms = 1e300, miss_ms = 1e300;
+    long hit_probes = 0, miss_probes = 0;
+
+    for (int r = 0; r < kRepeats; r++)
+    {
+        HashTableType table(args...);
+        auto start = chrono::steady_clock::now();
+        for (const Key &w : words)
+            table.Insert(w);
+        insert_ms = min(insert_ms, MsSince(start));
+
+        hit_probes = 0;
+        start = chrono::steady_clock::now();
+        for (const Key &w : words)
+            hit_probes += abs(table.Contains(w));
+        hit_ms = min(hit_ms, MsSince(start));
+
+        miss_probes = 0;
+        start = chrono::steady_clock::now();
+        for (const Key &w : misses)
+            miss_probes += abs(table.Contains(w));
+        miss_ms = min(miss_ms, MsSince(start));
+    }
+
+    cout << name << ": insert " << insert_ms << " ms, hits " << hit_ms << " ms ("
+         << hit_probes / (words.size() * 1.0) << " probes), misses " << miss_ms << " ms ("
+         << miss_probes / (misses.size() * 1.0) << " probes)" << endl;
+}
+
+// @keys: keys to look up
+// Prints the mean and longest probe lengths of the lookups, and the share
+// of them in each power-of-two band: 1, 2, 3-4, 5-8, ... probes.
+template <typename HashTableType, typename Key>
+void PrintProbeLengths(const string &name, HashTableType &table, const vector<Key> &keys)
+{
+    vector<size_t> bands;
+    size_t total = 0, longest = 0;
+    for (const Key &k : keys)
+    {
+        size_t probes = abs(table.Contains(k));
+        total += probes;
+        longest = max(longest, probes);
+
+        size_t band = 0;
+        while ((size_t(1) << band) < probes)
+            band++;
+        if (bands.size() <= band)
+            bands.resize(band + 1, 0);
+        bands[band]++;
+    }
+
+    cout << "  " << name << ": mean " << total / (keys.size() * 1.0) << ", max " << longest << " |";
+    for (size_t b = 0; b < bands.size(); b++)
+        cout << " <=" << (size_t(1) << b) << ": " << 100.0 * bands[b] / keys.size() << "%";
+    cout << endl;
+}
+
+// Probe lengths of hits and misses on words, then after kChurnRounds of
+// removing the oldest of kChurnKeys ints and inserting a new one.
+template <typename WordTable, typename IntTable>
+void ReportProbeLengths(const string &name, const vector<string> &words, const vector<string> &misses)
+{
+    WordTable word_table;
+    for (const string &w : words)
+        word_table.Insert(w);
+    cout << name << ", words:" << endl;
+    PrintProbeLengths("hits", word_table, words);
+    PrintProbeLengths("misses", word_table, misses);
+
+    // The first kChurnKeys keys go in; each round's new key is the next one.
+    vector<int> churn, unused;
+    MakeIntKeys(kChurnKeys + kChurnRounds, UNIFORM, churn, unused);
+    vector<int> live(churn.begin(), churn.begin() + kChurnKeys);
+    IntTable table;
+    for (int k : live)
+        table.Insert(k);
+
+    auto start = chrono::steady_clock::now();
+    for (size_t r = 0; r < kChurnRounds; r++)
+    {
+        size_t oldest = r % kChurnKeys;
+        table.Remove(live[oldest]);
+        live[oldest] = churn[kChurnKeys + r];
+        table.Insert(live[oldest]);
+    }
+    double churn_ms = MsSince(start);
+
+    vector<int> churn_misses(kChurnKeys);
+    for (size_t i = 0; i < kChurnKeys; i++)
+        churn_misses[i] = live[i] + 1;
+    start = chrono::steady_clock::now();
+    for (int k : live)
+        table.Contains(k);
+    double hit_ms = MsSince(start);
+
+    cout << name << ", ints after churn (" << churn_ms << " ms, table of " << table.get_table_data()[1]
+         << ", lookups " << hit_ms << " ms):" << endl;
+    PrintProbeLengths("hits", table, live);
+    PrintProbeLengths("misses", table, churn_misses);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2 && argc != 3)
+    {
+        cout << "Usage: " << argv[0] << " <wordsfilename> [probes | distribution]" << endl;
+        cout << "  distribution of the int keys: uniform (default), sorted, reverse, nearly," << endl;
+        cout << "  fewunique, organpipe, zipf, sawtooth" << endl;
+        return 0;
+    }
+
+    // probes: only the probe-length distributions.
+    bool probes = argc == 3 && string(argv[2]) == "probes";
+    Distribution dist = UNIFORM;
+    if (argc == 3 && !probes && !parse_distribution(argv[2], dist))
+    {
+        cerr << "Unknown distribution " << argv[2] << endl;
+        return 1;
+    }
+
+    ifstream words_file(argv[1]);
+    if (words_file.fail())
+    {
+        cerr << "ERROR";
+        abort();
+    }
+
+    // Each word with a character it never has appended is a miss.
+    vector<string> words, misses;
+    string line;
+    while (getline(words_file, line))
+    {
+        words.push_back(line);
+        misses.push_back(line + "#");
+    }
+
+    if (probes)
+    {
+        cout << words.size() << " words; churn of " << kChurnKeys << " ints over " << kChurnRounds
+             << " removes" << endl;
+        ReportProbeLengths<HashTableLinear<string>, HashTableLinear<int>>("linear", words, misses);
+        ReportProbeLengths<HashTableRobinHood<string>, HashTableRobinHood<int>>("robin hood", words, misses);
+        return 0;
+    }
+
+    cout << words.size() << " words, best of " << kRepeats << endl;
+
+    BenchHashTable<HashTableLinear<string>>("linear", words, misses);
+    BenchHashTable<HashTableLinear<string, PowerOfTwoCapacity>>("linear, power of two", words, misses);
+    BenchHashTable<HashTable<string>>("quadratic", words, misses);
+    BenchHashTable<HashTable<string, PowerOfTwoCapacity>>("quadratic, power of two", words, misses);
+    BenchHashTable<HashTableDouble<string>>("double", words, misses, kDoubleR);
+    BenchHashTable<HashTableDouble<string, PowerOfTwoCapacity>>("double, power of two", words, misses, kDoubleR);
+    BenchHashTable<HashTableRobinHood<string>>("robin hood", words, misses);
+    BenchHashTable<HashTableSwiss<string>>("swiss", words, misses);
+
+    // Integer keys hash for free, so the modulo is a larger share of a lookup.
+    // Skewed distributions repeat keys, so some inserts find theirs present.
+    vector<int> keys, int_misses;
+    MakeIntKeys(kIntKeys, dist, keys, int_misses);
+    cout << endl << kIntKeys << " " << distribution_name(dist) << " ints, best of " << kRepeats << endl;
+
+    BenchHashTable<HashTableLinear<int>>("linear", keys, int_misses);
+    BenchHashTable<HashTableLinear<int, PowerOfTwoCapacity>>("linear, power of two", keys, int_misses);
+    BenchHashTable<HashTable<int>>("quadratic", keys, int_misses);
+    BenchHashTable<HashTable<int, PowerOfTwoCapacity>>("quadratic, power of two", keys, int_misses);
+    BenchHashTable<HashTableDouble<int>>("double", keys, int_misses, kDoubleR);
+    BenchHashTable<HashTableDouble<int, PowerOfTwoCapacity>>("double, power of two", keys, int_misses, kDoubleR);
+    BenchHashTable<HashTableRobinHood<int>>("robin hood", keys, int_misses);
+    BenchHashTable<HashTableSwiss<int>>("swiss", keys, int_misses);
+    return 0;
+}
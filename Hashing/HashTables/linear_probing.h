@@ -5,9 +5,11 @@
 #include <algorithm>
 #include <functional>
 
+#include "capacity_policy.h"
 
-// Linear probing implementation.
-template <typename HashedObj>
+// Linear probing implementation. CapacityPolicy (capacity_policy.h) picks
+// prime or power-of-two table sizes.
+template <typename HashedObj, typename CapacityPolicy = PrimeCapacity>
 class HashTableLinear
 {
 public:
@@ -23,10 +25,10 @@ public:
      * @param {default} size = 101 :
      *
      * Details:
-     *  - sets table's size with the next prime of size.
+     *  - sets table's size with the policy's capacity for size.
      *  - clears the tables's entries
      */
-    explicit HashTableLinear(size_t size = 101) : array_(NextPrime(size))
+    explicit HashTableLinear(size_t size = 101) : array_(CapacityPolicy::Capacity(size))
     {
         MakeEmpty();
     }
@@ -202,9 +204,8 @@ private:
         while (array_[current_pos].info_ != EMPTY &&
                array_[current_pos].element_ != x)
         {
-            current_pos += offset; // Compute ith probe.
-            if (current_pos >= array_.size())
-                current_pos -= array_.size();
+            // Compute ith probe.
+            current_pos = CapacityPolicy::Next(current_pos, offset, array_.size());
 
             collision_count_++;
             probe_count_++;
@@ -225,7 +226,7 @@ private:
     {
         std::vector<HashEntry> old_array = array_;
         // Create new double-sized, empty table.
-        array_.resize(NextPrime(2 * old_array.size()));
+        array_.resize(CapacityPolicy::Capacity(2 * old_array.size()));
         for (auto &entry : array_)
             entry.info_ = EMPTY;
 
@@ -245,7 +246,7 @@ private:
     size_t InternalHash(const HashedObj &x) const
     {
         static std::hash<HashedObj> hf;
-        return hf(x) % array_.size();
+        return CapacityPolicy::Index(hf(x), array_.size());
     }
 };
 
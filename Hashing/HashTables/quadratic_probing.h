@@ -5,39 +5,11 @@
 #include <algorithm>
 #include <functional>
 
-namespace
-{
-
-  // Internal method to test if a positive number is prime.
-  bool IsPrime(size_t n)
-  {
-    if (n == 2 || n == 3)
-      return true;
-
-    if (n == 1 || n % 2 == 0)
-      return false;
-
-    for (int i = 3; i * i <= n; i += 2)
-      if (n % i == 0)
-        return false;
-
-    return true;
-  }
-
-  // Internal method to return a prime number at least as large as n.
-  int NextPrime(size_t n)
-  {
-    if (n % 2 == 0)
-      ++n;
-    while (!IsPrime(n))
-      n += 2;
-    return n;
-  }
-
-} // namespace
+#include "capacity_policy.h"
 
-// Quadratic probing implementation.
-template <typename HashedObj>
+// Quadratic probing implementation. CapacityPolicy (capacity_policy.h) picks
+// prime or power-of-two table sizes, and with them the probe sequence.
+template <typename HashedObj, typename CapacityPolicy = PrimeCapacity>
 class HashTable
 {
 public:
@@ -53,10 +25,10 @@ public:
    * @param {default} size = 101 :
    *
    * Details:
-   *  - sets table's size with the next prime of size.
+   *  - sets table's size with the policy's capacity for size.
    *  - clears the tables's entries
    */
-  explicit HashTable(size_t size = 101) : array_(NextPrime(size))
+  explicit HashTable(size_t size = 101) : array_(CapacityPolicy::Capacity(size))
   {
     MakeEmpty();
   }
@@ -231,6 +203,8 @@ private:
    *  - Returns an index regardless of whether the key is active or not.
    *  - (quadratic only) offset is set 1, but increments by 2
    *    with each collision, hence quadratic
+   *  - (power-of-two sizes) offset increments by 1, so the probes land on
+   *    triangular numbers, which visit every slot
    */
   size_t FindPos(const HashedObj &x)
   {
@@ -240,10 +214,9 @@ private:
     while (array_[current_pos].info_ != EMPTY &&
            array_[current_pos].element_ != x)
     {
-      current_pos += offset; // Compute ith probe.
-      offset += 2;
-      if (current_pos >= array_.size())
-        current_pos -= array_.size();
+      // Compute ith probe.
+      current_pos = CapacityPolicy::Next(current_pos, offset, array_.size());
+      offset += CapacityPolicy::kQuadraticStep;
 
       collision_count_++;
       probe_count_++;
@@ -264,7 +237,7 @@ private:
   {
     std::vector<HashEntry> old_array = array_;
     // Create new double-sized, empty table.
-    array_.resize(NextPrime(2 * old_array.size()));
+    array_.resize(CapacityPolicy::Capacity(2 * old_array.size()));
     for (auto &entry : array_)
       entry.info_ = EMPTY;
 
@@ -284,7 +257,7 @@ private:
   size_t InternalHash(const HashedObj &x) const
   {
     static std::hash<HashedObj> hf;
-    return hf(x) % array_.size();
+    return CapacityPolicy::Index(hf(x), array_.size());
   }
 };
 
@@ -0,0 +1,259 @@
+#ifndef ROBIN_HOOD_H
+#define ROBIN_HOOD_H
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <functional>
+
+#include "capacity_policy.h"
+
+/*
+ * Robin Hood linear probing (Celis, 1986), with backward-shift deletion.
+ *
+ * Each entry keeps its probe distance, how far it sits past its home slot.
+ * An insert walking the probe sequence takes the slot of any entry closer
+ * to home than the insert is ("richer"), and carries that entry on. Within
+ * a run of occupied slots the entries then sit in order of their home, so:
+ *  - a lookup stops at the first entry with a smaller distance than its own,
+ *    since x would have displaced it; misses end as early as hits;
+ *  - the mean probe length is that of plain linear probing, but the longest
+ *    ones shrink, because the distance is shared out evenly.
+ * Remove shifts the entries after the hole back by one until an empty slot
+ * or an entry already at home, so there are no DELETED markers and delete-
+ * heavy workloads keep short probes without waiting for a Rehash.
+ */
+template <typename HashedObj, typename CapacityPolicy = PrimeCapacity>
+class HashTableRobinHood
+{
+public:
+    /**
+     *  Robin Hood HashTable constructor
+     * @param {default} size = 101 :
+     *
+     * Details:
+     *  - sets table's size with the policy's capacity for size.
+     *  - clears the tables's entries
+     */
+    explicit HashTableRobinHood(size_t size = 101) : array_(CapacityPolicy::Capacity(size))
+    {
+        MakeEmpty();
+    }
+
+    /**
+     *  Contains function
+     * @param  {HashedObj} x :
+     * @return {int}         :
+     *
+     * Details:
+     *  - Returns the number of probes per query
+     *  - if return is negative, it is inactive, else active.
+     */
+    int Contains(const HashedObj &x)
+    {
+        probe_count_ = 1;
+        if (FindPos(x) == kNotFound)
+            probe_count_ *= -1;
+        return probe_count_;
+    }
+
+    /**
+     *  Emptying function
+     *
+     * Details:
+     *  - Clears the values of all entries in the table.
+     */
+    void MakeEmpty()
+    {
+        current_size_ = 0;
+        collision_count_ = 0;
+        for (auto &entry : array_)
+            entry.distance_ = kEmpty;
+    }
+
+    /**
+     *  Insertion function (l-value)
+     * @param  {HashedObj} x :
+     * @return {bool}        :
+     */
+    bool Insert(const HashedObj &x)
+    {
+        HashedObj copy = x;
+        return Insert(std::move(copy));
+    }
+
+    /**
+     * Insertion function (r-value)
+     * @param  {HashedObj} &x :
+     * @return {bool}         :
+     *
+     * Details:
+     *  - Returns false if x is already in the table.
+     *  - Doubles the table first if x would fill more than half of it.
+     *  - Places x, displacing richer entries on the way.
+     */
+    bool Insert(HashedObj &&x)
+    {
+        if (FindPos(x) != kNotFound)
+            return false;
+
+        // Rehash; see Section 5.5
+        if (++current_size_ > array_.size() / 2)
+            Rehash();
+
+        Place(std::move(x));
+        return true;
+    }
+
+    /**
+     * Remove function for HashTable
+     * @param  {HashedObj} x :
+     * @return {bool}        :
+     *
+     * Details:
+     *  - Empties x's slot, then shifts each following entry back one slot,
+     *    one closer to home, until an empty slot or an entry at home.
+     */
+    bool Remove(const HashedObj &x)
+    {
+        size_t hole = FindPos(x);
+        if (hole == kNotFound)
+            return false;
+
+        size_t next = CapacityPolicy::Next(hole, 1, array_.size());
+        while (array_[next].distance_ > 0)
+        {
+            array_[hole].element_ = std::move(array_[next].element_);
+            array_[hole].distance_ = array_[next].distance_ - 1;
+            hole = next;
+            next = CapacityPolicy::Next(next, 1, array_.size());
+        }
+
+        array_[hole].distance_ = kEmpty;
+        current_size_--;
+        return true;
+    }
+
+    /**
+     *  Table Data Acessor
+     * @return {size_t get_table_data()*}  :
+     *
+     * Details:
+     *  - Returns private members of the class as a static array.
+     */
+    size_t *get_table_data()
+    {
+        static size_t data[3];
+        data[0] = current_size_;
+        data[1] = array_.size();
+        data[2] = collision_count_;
+        return data;
+    }
+
+private:
+    static constexpr int kEmpty = -1;
+    static constexpr size_t kNotFound = static_cast<size_t>(-1);
+
+    struct HashEntry
+    {
+        HashedObj element_;
+        int distance_; // probes past home; kEmpty if unused
+
+        HashEntry(const HashedObj &e = HashedObj{}, int d = kEmpty)
+            : element_{e}, distance_{d} {}
+    };
+
+    // private members
+    std::vector<HashEntry> array_;
+    size_t current_size_;
+    size_t collision_count_;
+    int probe_count_;
+
+    /**
+     *  Find Position Function
+     * @param  {HashedObj} x :
+     * @return {size_t}      :
+     *
+     * Details:
+     *  - Searches the table with the hash function, given key.
+     *  - Stops at an empty slot, or at an entry richer than x would be there.
+     *  - Increments collisions and number of probes (per query)
+     *  - Returns x's index, or kNotFound.
+     */
+    size_t FindPos(const HashedObj &x)
+    {
+        size_t current_pos = InternalHash(x);
+
+        for (int distance = 0; array_[current_pos].distance_ >= distance; distance++)
+        {
+            if (array_[current_pos].element_ == x)
+                return current_pos;
+
+            // Compute ith probe.
+            current_pos = CapacityPolicy::Next(current_pos, 1, array_.size());
+            collision_count_++;
+            probe_count_++;
+        }
+
+        return kNotFound;
+    }
+
+    /**
+     *  Placing function
+     * @param  {HashedObj} x :
+     *
+     * Details:
+     *  - Walks x's probe sequence. Where x is further from home than the
+     *    entry it meets, x takes the slot and the evicted entry walks on.
+     */
+    void Place(HashedObj &&x)
+    {
+        size_t current_pos = InternalHash(x);
+        int distance = 0;
+
+        while (array_[current_pos].distance_ != kEmpty)
+        {
+            if (array_[current_pos].distance_ < distance)
+            {
+                std::swap(x, array_[current_pos].element_);
+                std::swap(distance, array_[current_pos].distance_);
+            }
+            current_pos = CapacityPolicy::Next(current_pos, 1, array_.size());
+            distance++;
+            collision_count_++;
+        }
+
+        array_[current_pos].element_ = std::move(x);
+        array_[current_pos].distance_ = distance;
+    }
+
+    /**
+     *  Rehashing function
+     *
+     * Details:
+     *  - Double size and move the entries over.
+     */
+    void Rehash()
+    {
+        std::vector<HashEntry> old_array;
+        old_array.swap(array_);
+        array_.resize(CapacityPolicy::Capacity(2 * old_array.size()));
+
+        for (auto &entry : old_array)
+            if (entry.distance_ != kEmpty)
+                Place(std::move(entry.element_));
+    }
+
+    /**
+     *   Simple Hash Function
+     * @param  {HashedObj} x :
+     * @return {size_t}      :
+     */
+    size_t InternalHash(const HashedObj &x) const
+    {
+        static std::hash<HashedObj> hf;
+        return CapacityPolicy::Index(hf(x), array_.size());
+    }
+};
+
+#endif // ROBIN_HOOD_H
@@ -0,0 +1,354 @@
+#ifndef SWISS_TABLE_H
+#define SWISS_TABLE_H
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*
+ * Swiss-table layout for HashTableLinear's workload (Abseil's flat_hash_set).
+ *
+ * HashTableLinear keeps the element and its EntryType together, so every
+ * probe loads a whole HashEntry and, for strings, compares keys on every
+ * occupied slot it passes. Here the state lives in a separate array of
+ * one-byte control words, one per slot:
+ *  - kEmpty (0x80) and kDeleted (0xFE), the top bit set;
+ *  - a full slot holds 7 bits of the key's hash (its tag), the top bit clear.
+ * Slots come in groups of 16. A probe loads a group's 16 control bytes in one
+ * SSE2 load and compares them all with the tag, so a key is only compared on
+ * slots whose tag matched, about 1 in 128 of the others. Groups are probed
+ * with triangular steps (1, 2, 3, ...), which visit every group of a
+ * power-of-two table. A lookup stops at the first group holding an empty slot.
+ */
+template <typename HashedObj>
+class HashTableSwiss
+{
+public:
+    static constexpr size_t kGroupSize = 16;
+
+    /**
+     *  Swiss HashTable constructor
+     * @param {default} size = 101 :
+     *
+     * Details:
+     *  - rounds size up to a power of two, at least one group.
+     *  - clears the tables's entries
+     */
+    explicit HashTableSwiss(size_t size = 101)
+    {
+        Resize(size);
+        MakeEmpty();
+    }
+
+    /**
+     *  Contains function
+     * @param  {HashedObj} x :
+     * @return {int}         :
+     *
+     * Details:
+     *  - Returns the number of groups probed per query
+     *  - if return is negative, it is inactive, else active.
+     */
+    int Contains(const HashedObj &x)
+    {
+        probe_count_ = 1;
+        if (Find(x) == kNotFound)
+            probe_count_ *= -1;
+        return probe_count_;
+    }
+
+    /**
+     *  Emptying function
+     *
+     * Details:
+     *  - Marks every control byte empty.
+     */
+    void MakeEmpty()
+    {
+        current_size_ = 0;
+        deleted_count_ = 0;
+        collision_count_ = 0;
+        key_compares_ = 0;
+        std::fill(ctrl_.begin(), ctrl_.end(), kEmpty);
+    }
+
+    /**
+     *  Insertion function (l-value)
+     * @param  {HashedObj} x :
+     * @return {bool}        :
+     *
+     * Details:
+     *  - Returns false if x is already in the table.
+     *  - Otherwise takes the first empty or deleted slot on x's probe sequence.
+     *  - Rehashes once live and deleted slots fill 7/8 of the table.
+     */
+    bool Insert(const HashedObj &x)
+    {
+        HashedObj copy = x;
+        return Insert(std::move(copy));
+    }
+
+    /**
+     * Insertion function (r-value)
+     * @param  {HashedObj} &x :
+     * @return {bool}         :
+     */
+    bool Insert(HashedObj &&x)
+    {
+        size_t hash = Hash(x);
+        if (Find(x, hash) != kNotFound)
+            return false;
+
+        if (current_size_ + deleted_count_ + 1 > MaxLoad())
+        {
+            Rehash();
+        }
+
+        size_t pos = FindFree(hash);
+        if (ctrl_[pos] == kDeleted)
+            deleted_count_--;
+        ctrl_[pos] = Tag(hash);
+        slots_[pos] = std::move(x);
+        current_size_++;
+        return true;
+    }
+
+    /**
+     * Remove function for HashTable
+     * @param  {HashedObj} x :
+     * @return {bool}        :
+     *
+     * Details:
+     *  - If x's group still has an empty slot, no probe ever went past this
+     *    group, so the slot goes back to empty. Otherwise it is marked deleted.
+     */
+    bool Remove(const HashedObj &x)
+    {
+        size_t pos = Find(x);
+        if (pos == kNotFound)
+            return false;
+
+        if (MatchEmpty(pos & ~(kGroupSize - 1)) != 0)
+        {
+            ctrl_[pos] = kEmpty;
+        }
+        else
+        {
+            ctrl_[pos] = kDeleted;
+            deleted_count_++;
+        }
+        current_size_--;
+        return true;
+    }
+
+    /**
+     *  Table Data Acessor
+     * @return {size_t get_table_data()*}  :
+     *
+     * Details:
+     *  - Returns the element count, slot count, extra groups probed by
+     *    inserts, and the key compares made, as a static array.
+     */
+    size_t *get_table_data()
+    {
+        static size_t data[4];
+        data[0] = current_size_;
+        data[1] = slots_.size();
+        data[2] = collision_count_;
+        data[3] = key_compares_;
+        return data;
+    }
+
+private:
+    static constexpr int8_t kEmpty = static_cast<int8_t>(0x80);
+    static constexpr int8_t kDeleted = static_cast<int8_t>(0xFE);
+    static constexpr size_t kNotFound = static_cast<size_t>(-1);
+
+    // private members
+    std::vector<int8_t> ctrl_;     // one control byte per slot
+    std::vector<HashedObj> slots_;
+    size_t group_mask_;            // groups - 1
+    size_t current_size_;
+    size_t deleted_count_;
+    size_t collision_count_;
+    size_t key_compares_;
+    int probe_count_;
+
+    /**
+     *  Hash Function
+     * @param  {HashedObj} x :
+     * @return {size_t}      :
+     *
+     * Details:
+     *  - std::hash mixed by a Fibonacci multiply, folded so the low 7 bits
+     *    (the tag) and the bits above them (the group) both see the whole key.
+     */
+    static size_t Hash(const HashedObj &x)
+    {
+        static std::hash<HashedObj> hf;
+        uint64_t h = static_cast<uint64_t>(hf(x)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(h ^ (h >> 32));
+    }
+
+    static int8_t Tag(size_t hash)
+    {
+        return static_cast<int8_t>(hash & 0x7F);
+    }
+
+    size_t FirstGroup(size_t hash) const
+    {
+        return (hash >> 7) & group_mask_;
+    }
+
+    size_t MaxLoad() const
+    {
+        return slots_.size() - slots_.size() / 8;
+    }
+
+    // Bit i set when control byte i of the group at slot base equals c.
+    unsigned Match(size_t base, int8_t c) const
+    {
+#if defined(__SSE2__)
+        __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&ctrl_[base]));
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(c)));
+#else
+        unsigned mask = 0;
+        for (size_t i = 0; i < kGroupSize; i++)
+            mask |= static_cast<unsigned>(ctrl_[base + i] == c) << i;
+        return mask;
+#endif
+    }
+
+    unsigned MatchEmpty(size_t base) const
+    {
+        return Match(base, kEmpty);
+    }
+
+    // Empty and deleted are the control bytes with the top bit set.
+    unsigned MatchFree(size_t base) const
+    {
+#if defined(__SSE2__)
+        return _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&ctrl_[base])));
+#else
+        unsigned mask = 0;
+        for (size_t i = 0; i < kGroupSize; i++)
+            mask |= static_cast<unsigned>(ctrl_[base + i] < 0) << i;
+        return mask;
+#endif
+    }
+
+    size_t Find(const HashedObj &x)
+    {
+        return Find(x, Hash(x));
+    }
+
+    /**
+     *  Find Function
+     * @param  {HashedObj} x, {size_t} hash :
+     * @return {size_t}                     :
+     *
+     * Details:
+     *  - Compares x only with the slots whose tag matches.
+     *  - Increments the number of probes (per query) for each extra group.
+     *  - Returns x's slot, or kNotFound.
+     */
+    size_t Find(const HashedObj &x, size_t hash)
+    {
+        int8_t tag = Tag(hash);
+        size_t group = FirstGroup(hash);
+
+        for (size_t step = 1;; step++)
+        {
+            size_t base = group * kGroupSize;
+            for (unsigned m = Match(base, tag); m != 0; m &= m - 1)
+            {
+                size_t pos = base + __builtin_ctz(m);
+                key_compares_++;
+                if (slots_[pos] == x)
+                    return pos;
+            }
+            if (MatchEmpty(base) != 0 || step > group_mask_)
+                return kNotFound;
+
+            group = (group + step) & group_mask_; // Compute ith probe.
+            probe_count_++;
+        }
+    }
+
+    // First empty or deleted slot on hash's probe sequence. MaxLoad keeps one.
+    size_t FindFree(size_t hash)
+    {
+        size_t group = FirstGroup(hash);
+        for (size_t step = 1;; step++)
+        {
+            size_t base = group * kGroupSize;
+            unsigned m = MatchFree(base);
+            if (m != 0)
+                return base + __builtin_ctz(m);
+
+            group = (group + step) & group_mask_;
+            collision_count_++;
+        }
+    }
+
+    void Resize(size_t size)
+    {
+        size_t groups = 1;
+        while (groups * kGroupSize < size)
+            groups *= 2;
+        ctrl_.assign(groups * kGroupSize, kEmpty);
+        slots_.clear();
+        slots_.resize(groups * kGroupSize);
+        group_mask_ = groups - 1;
+    }
+
+    /**
+     *  Rehashing function
+     *
+     * Details:
+     *  - Doubles the table, unless under 7/16 of it is live, in which case
+     *    deleted slots take up the rest and it rebuilds at the same size.
+     *  - Moves the live elements over; their hashes are recomputed.
+     */
+    void Rehash()
+    {
+        std::vector<int8_t> old_ctrl;
+        std::vector<HashedObj> old_slots;
+        old_ctrl.swap(ctrl_);
+        old_slots.swap(slots_);
+
+        size_t size = old_ctrl.size();
+        if (current_size_ >= size / 2 - size / 16)
+            size *= 2;
+        Resize(size);
+
+        deleted_count_ = 0;
+        for (size_t i = 0; i < old_ctrl.size(); i++)
+        {
+            if (old_ctrl[i] >= 0)
+            {
+                size_t hash = Hash(old_slots[i]);
+                size_t pos = FindFree(hash);
+                ctrl_[pos] = Tag(hash);
+                slots_[pos] = std::move(old_slots[i]);
+            }
+        }
+    }
+};
+
+// Out-of-class definitions, needed in C++14 when the constants bind to references.
+template <typename HashedObj>
+constexpr size_t HashTableSwiss<HashedObj>::kGroupSize;
+template <typename HashedObj>
+constexpr int8_t HashTableSwiss<HashedObj>::kEmpty;
+template <typename HashedObj>
+constexpr int8_t HashTableSwiss<HashedObj>::kDeleted;
+template <typename HashedObj>
+constexpr size_t HashTableSwiss<HashedObj>::kNotFound;
+
+#endif // SWISS_TABLE_H
@@ -0,0 +1,194 @@
+// tests.cc: checks every table against std::unordered_set over random
+// inserts, removes and lookups, so Remove is tested together with the
+// lookups that have to see past it.
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+// This doctest sizes a static array by SIGSTKSZ, which newer glibc no longer
+// makes a constant.
+#define DOCTEST_CONFIG_NO_POSIX_SIGNALS
+#include "../Hash/doctest.h"
+
+#include <random>
+#include <string>
+#include <unordered_set>
+
+#include "quadratic_probing.h"
+#include "linear_probing.h"
+#include "double_hashing.h"
+#include "swiss_table.h"
+#include "robin_hood.h"
+
+using namespace std;
+
+const int kKeyRange = 2000;
+const int kOps = 20000;
+const int kDoubleR = 89;
+
+template <typename Key>
+Key MakeKey(int k);
+
+template <>
+int MakeKey<int>(int k)
+{
+    return k;
+}
+
+template <>
+string MakeKey<string>(int k)
+{
+    return "key" + to_string(k);
+}
+
+// @table: an empty table
+// @seed: seeds the operations
+// Runs kOps random inserts, removes and lookups of keys below kKeyRange on
+// table and on a reference set, checking that each returns the same. Then
+// looks up every key, so both the live ones and the removed ones are checked
+// after the last Remove. Returns the reference set.
+template <typename HashTableType, typename Key>
+unordered_set<int> CheckAgainstSet(HashTableType &table, unsigned seed)
+{
+    unordered_set<int> reference;
+    mt19937 gen(seed);
+    for (int i = 0; i < kOps; i++)
+    {
+        int k = gen() % kKeyRange;
+        switch (gen() % 3)
+        {
+        case 0:
+            CHECK(table.Insert(MakeKey<Key>(k)) == reference.insert(k).second);
+            break;
+        case 1:
+            CHECK(table.Remove(MakeKey<Key>(k)) == (reference.erase(k) == 1));
+            break;
+        default:
+            CHECK((table.Contains(MakeKey<Key>(k)) > 0) == (reference.count(k) == 1));
+            break;
+        }
+    }
+
+    for (int k = 0; k < kKeyRange; k++)
+        CHECK((table.Contains(MakeKey<Key>(k)) > 0) == (reference.count(k) == 1));
+    return reference;
+}
+
+// The textbook tables leave current_size_ alone on Remove, so only the
+// lookups are checked.
+TEST_CASE("linear probing")
+{
+    HashTableLinear<int> prime_ints;
+    CheckAgainstSet<HashTableLinear<int>, int>(prime_ints, 1);
+    HashTableLinear<string, PowerOfTwoCapacity> pow2_words;
+    CheckAgainstSet<HashTableLinear<string, PowerOfTwoCapacity>, string>(pow2_words, 2);
+}
+
+TEST_CASE("quadratic probing")
+{
+    HashTable<int> prime_ints;
+    CheckAgainstSet<HashTable<int>, int>(prime_ints, 3);
+    HashTable<string, PowerOfTwoCapacity> pow2_words;
+    CheckAgainstSet<HashTable<string, PowerOfTwoCapacity>, string>(pow2_words, 4);
+}
+
+TEST_CASE("double hashing")
+{
+    HashTableDouble<int> prime_ints(kDoubleR);
+    CheckAgainstSet<HashTableDouble<int>, int>(prime_ints, 5);
+    HashTableDouble<string> prime_words(kDoubleR);
+    CheckAgainstSet<HashTableDouble<string>, string>(prime_words, 6);
+    HashTableDouble<int, PowerOfTwoCapacity> pow2_ints(kDoubleR);
+    CheckAgainstSet<HashTableDouble<int, PowerOfTwoCapacity>, int>(pow2_ints, 7);
+    HashTableDouble<string, PowerOfTwoCapacity> pow2_words(kDoubleR);
+    CheckAgainstSet<HashTableDouble<string, PowerOfTwoCapacity>, string>(pow2_words, 8);
+}
+
+TEST_CASE("robin hood backward shift")
+{
+    unordered_set<int> live;
+    HashTableRobinHood<int> prime_ints;
+    live = CheckAgainstSet<HashTableRobinHood<int>, int>(prime_ints, 9);
+    CHECK(prime_ints.get_table_data()[0] == live.size());
+    HashTableRobinHood<string> prime_words;
+    live = CheckAgainstSet<HashTableRobinHood<string>, string>(prime_words, 10);
+    CHECK(prime_words.get_table_data()[0] == live.size());
+    HashTableRobinHood<int, PowerOfTwoCapacity> pow2_ints;
+    live = CheckAgainstSet<HashTableRobinHood<int, PowerOfTwoCapacity>, int>(pow2_ints, 11);
+    CHECK(pow2_ints.get_table_data()[0] == live.size());
+    HashTableRobinHood<string, PowerOfTwoCapacity> pow2_words;
+    live = CheckAgainstSet<HashTableRobinHood<string, PowerOfTwoCapacity>, string>(pow2_words, 12);
+    CHECK(pow2_words.get_table_data()[0] == live.size());
+}
+
+TEST_CASE("robin hood remove wraps around the table")
+{
+    // A 16-slot table holds 8 keys before it doubles. Over these seeds some
+    // runs of 7 keys wrap from the last slot to the first, and removing every
+    // key in turn shifts entries back across the wrap.
+    for (unsigned seed = 0; seed < 64; seed++)
+    {
+        HashTableRobinHood<int, PowerOfTwoCapacity> table(16);
+        unordered_set<int> reference;
+        mt19937 gen(seed);
+        while (reference.size() < 7)
+        {
+            int k = gen() % kKeyRange;
+            CHECK(table.Insert(k) == reference.insert(k).second);
+        }
+        REQUIRE(table.get_table_data()[1] == 16);
+
+        while (!reference.empty())
+        {
+            int removed = *reference.begin();
+            CHECK(table.Remove(removed));
+            reference.erase(removed);
+            CHECK(table.Contains(removed) < 0);
+            for (int k : reference)
+                CHECK(table.Contains(k) > 0);
+        }
+        CHECK(table.get_table_data()[0] == 0);
+    }
+}
+
+TEST_CASE("swiss table")
+{
+    unordered_set<int> live;
+    HashTableSwiss<int> ints;
+    live = CheckAgainstSet<HashTableSwiss<int>, int>(ints, 13);
+    CHECK(ints.get_table_data()[0] == live.size());
+    HashTableSwiss<string> words;
+    live = CheckAgainstSet<HashTableSwiss<string>, string>(words, 14);
+    CHECK(words.get_table_data()[0] == live.size());
+}
+
+TEST_CASE("swiss table remove from a full group")
+{
+    // Two groups of 16 hold 27 keys without a rehash. A miss that probes
+    // both groups starts in a full one; inserted, it goes to the other
+    // group. Removing the keys of the full group must leave DELETED behind,
+    // or the lookup of the overflowed key would stop early.
+    HashTableSwiss<int> table(32);
+    for (int k = 0; k < 27; k++)
+        table.Insert(k);
+    REQUIRE(table.get_table_data()[1] == 32);
+
+    int overflow = kKeyRange;
+    while (table.Contains(overflow) != -2)
+        overflow++;
+    CHECK(table.Insert(overflow));
+    CHECK(table.Contains(overflow) == 2);
+    REQUIRE(table.get_table_data()[1] == 32);
+
+    for (int k = 0; k < 27; k++)
+    {
+        CHECK(table.Remove(k));
+        CHECK(table.Contains(k) < 0);
+        CHECK(table.Contains(overflow) > 0);
+        for (int live = k + 1; live < 27; live++)
+            CHECK(table.Contains(live) > 0);
+    }
+    CHECK(table.get_table_data()[0] == 1);
+
+    // The full group is now all DELETED, so a miss starting there still
+    // probes both groups.
+    CHECK(table.Remove(overflow));
+    CHECK(table.Contains(overflow) == -2);
+}
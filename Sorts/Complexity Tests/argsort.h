@@ -0,0 +1,107 @@
+#ifndef ARGSORT_H
+#define ARGSORT_H
+
+#include <vector>
+#include <thread>
+#include <cstdint>
+#include <algorithm>
+
+#include "radix_sort.h"
+
+
+/* Argsort for record tables kept as structure-of-arrays columns.
+   argsort sorts (key, index) pairs packed into one uint64: the
+   order-preserving key (radix_key) in the high half, the row index in the
+   low half. Whole records never move during the sort, only 8-byte words.
+   The LSD radix passes cover just the key digits. The pairs start in
+   index order and every pass is stable, so equal keys stay in index order
+   without sorting the index bits. gather then applies the permutation to
+   each column, split across threads. */
+
+const int ARGSORT_RADIX_MIN = 1024;  // smaller inputs: one std::sort on the packed words
+
+
+inline uint64_t pack_key_index(int key, uint32_t index) {
+  return static_cast<uint64_t>(radix_key(key)) << 32 | index;
+}
+
+
+// perm[i] is the row of keys that belongs at position i of the sorted order.
+// Stable: equal keys keep their row order.
+inline void argsort(const std::vector<int> & keys, std::vector<uint32_t> & perm) {
+  size_t n = keys.size();
+  std::vector<uint64_t> packed(n);
+  std::vector<size_t> counts(RADIX_PASSES * RADIX_BUCKETS, 0);
+
+  for (size_t i = 0; i < n; i++) {
+    uint32_t key = radix_key(keys[i]);
+    packed[i] = static_cast<uint64_t>(key) << 32 | i;
+    for (int d = 0; d < RADIX_PASSES; d++) {
+      counts[d * RADIX_BUCKETS + ((key >> (d * RADIX_BITS)) & (RADIX_BUCKETS - 1))]++;
+    }
+  }
+
+  if (n < static_cast<size_t>(ARGSORT_RADIX_MIN)) {
+    std::sort(packed.begin(), packed.end());
+  } else {
+    std::vector<uint64_t> scratch(n);
+    uint64_t * from = packed.data();
+    uint64_t * to = scratch.data();
+
+    for (int d = 0; d < RADIX_PASSES; d++) {
+      size_t * count = &counts[d * RADIX_BUCKETS];
+      int shift = 32 + d * RADIX_BITS;
+
+      // Same digit everywhere: the pass would be a copy.
+      if (count[(from[0] >> shift) & (RADIX_BUCKETS - 1)] == n) continue;
+
+      size_t sum = 0;
+      for (int b = 0; b < RADIX_BUCKETS; b++) {
+        size_t c = count[b];
+        count[b] = sum;
+        sum += c;
+      }
+
+      for (size_t i = 0; i < n; i++) {
+        uint64_t x = from[i];
+        to[count[(x >> shift) & (RADIX_BUCKETS - 1)]++] = x;
+      }
+      std::swap(from, to);
+    }
+    if (from != packed.data()) packed.swap(scratch);
+  }
+
+  perm.resize(n);
+  for (size_t i = 0; i < n; i++) {
+    perm[i] = static_cast<uint32_t>(packed[i]);
+  }
+}
+
+
+// out[i] = column[perm[i]], one contiguous slice of out per thread. Reads
+// are random, writes sequential.
+template <typename T>
+void gather(const std::vector<T> & column, const std::vector<uint32_t> & perm,
+            std::vector<T> & out, int threads = 1) {
+  size_t n = perm.size();
+  out.resize(n);
+  if (threads < 1) threads = 1;
+
+  size_t chunk = (n + threads - 1) / threads;
+  auto fill = [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      out[i] = column[perm[i]];
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (int t = 1; t < threads && t * chunk < n; t++) {
+    workers.emplace_back(fill, t * chunk, std::min(n, (t + 1) * chunk));
+  }
+  fill(0, std::min(n, chunk));
+  for (auto & w : workers) {
+    w.join();
+  }
+}
+
+#endif // ARGSORT_H
@@ -0,0 +1,132 @@
+#ifndef AUTO_SORT_H
+#define AUTO_SORT_H
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <span>
+#include <cstdint>
+#include <algorithm>
+
+#include "introsort.h"
+#include "radix_sort.h"
+#include "sample_sort.h"
+#include "sortlib.h"
+
+
+/* -a auto: looks at the input, then picks the engine that the benchmarks
+   in results.md show to be fastest for inputs like it.
+   1. Fewer than AUTO_SMALL keys: introsort. Radix passes don't pay off.
+   2. Presorted: the mean run length across AUTO_PROBES evenly spread
+      probes of AUTO_PROBE_LEN keys is at least AUTO_MIN_RUN. Powersort,
+      linear on sorted, reversed and few-run input.
+   3. Key range (max - min, one exact pass) below n: counting sort.
+   4. Heavy duplicates: at most AUTO_FEW_DISTINCT distinct keys in
+      AUTO_DUP_SAMPLE random picks, and n >= AUTO_DUP_MIN_N. Sample sort,
+      whose equality buckets take each repeated key in one pass.
+   5. Otherwise: LSD radix.
+   Everything but the min/max pass looks at a few thousand keys. */
+
+const size_t AUTO_SMALL = 1024;
+const int AUTO_PROBES = 64;
+const int AUTO_PROBE_LEN = 64;
+const double AUTO_MIN_RUN = 16;
+const int AUTO_DUP_SAMPLE = 1024;
+const int AUTO_FEW_DISTINCT = 64;
+const size_t AUTO_DUP_MIN_N = 1 << 19;
+
+
+struct AutoChoice {
+  char algorithm;      // the -a letter of the engine, 'R' for counting sort
+  std::string engine;
+  std::string reason;
+};
+
+
+// Mean length of the runs powersort would find inside the probes: a run
+// is non-descending, or strictly descending.
+inline double sampled_run_length(const std::vector<int> & a) {
+  size_t n = a.size();
+  size_t probe = std::min<size_t>(AUTO_PROBE_LEN, n);
+  long keys = 0, runs = 0;
+
+  for (int p = 0; p < AUTO_PROBES; p++) {
+    size_t start = (n - probe) * p / std::max(AUTO_PROBES - 1, 1);
+    const int * x = a.data() + start;
+    size_t i = 0;
+
+    while (i < probe) {
+      size_t j = i + 1;
+      if (j < probe && x[j] < x[i]) {
+        while (j < probe && x[j] < x[j - 1]) j++;
+      } else {
+        while (j < probe && x[j] >= x[j - 1]) j++;
+      }
+      runs++;
+      i = j;
+    }
+    keys += probe;
+  }
+  return static_cast<double>(keys) / runs;
+}
+
+
+// Distinct keys among AUTO_DUP_SAMPLE picks at splitmix64 positions.
+inline int sampled_distinct(const std::vector<int> & a) {
+  std::vector<int> sample(AUTO_DUP_SAMPLE);
+  uint64_t state = 0xD1B54A32D192ED03ull ^ a.size();
+
+  for (int & s : sample) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    s = a[(z ^ (z >> 31)) % a.size()];
+  }
+  std::sort(sample.begin(), sample.end());
+  return std::unique(sample.begin(), sample.end()) - sample.begin();
+}
+
+
+// Sorts a with the engine the rules above pick, and says which and why.
+inline AutoChoice auto_sort(std::vector<int> & a, int threads) {
+  size_t n = a.size();
+  std::ostringstream why;
+  why << std::setprecision(3);
+
+  if (n < AUTO_SMALL) {
+    introsort(a);
+    why << "n = " << n << " < " << AUTO_SMALL;
+    return {'i', "introsort", why.str()};
+  }
+
+  double run = sampled_run_length(a);
+  if (run >= AUTO_MIN_RUN) {
+    sortlib::power_sort(std::span<int>(a));
+    why << "presorted: mean sampled run length " << run << " >= " << AUTO_MIN_RUN;
+    return {'T', "powersort", why.str()};
+  }
+
+  auto bounds = std::minmax_element(a.begin(), a.end());
+  int lo = *bounds.first, hi = *bounds.second;
+  int64_t range = static_cast<int64_t>(hi) - lo;
+  if (range < static_cast<int64_t>(n)) {
+    counting_sort(a, lo, hi);
+    why << "key range " << range + 1 << " <= n = " << n;
+    return {'R', "counting", why.str()};
+  }
+
+  int distinct = sampled_distinct(a);
+  if (distinct <= AUTO_FEW_DISTINCT && n >= AUTO_DUP_MIN_N) {
+    sample_sort(a, threads);
+    why << "heavy duplicates: " << distinct << " distinct keys in " << AUTO_DUP_SAMPLE << " sampled";
+    return {'P', "sample sort", why.str()};
+  }
+
+  lsd_radix_sort(a);
+  why << "key range " << range + 1 << ", " << distinct << " distinct in " << AUTO_DUP_SAMPLE
+      << " sampled, mean run length " << run;
+  return {'R', "radix", why.str()};
+}
+
+#endif // AUTO_SORT_H
@@ -0,0 +1,818 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <memory>
+#include <getopt.h>
+
+#include "sorts.h"
+#include "datagen.h"
+#include "perf_counters.h"
+#include "kway_merge.h"
+#include "string_sort.h"
+#include "argsort.h"
+
+
+// Benchmark harness for the sort modes.
+// Every (algorithm, size) pair sorts the same seeded input: a few untimed
+// warmups, then REPS timed runs on a fresh copy, timed with steady_clock.
+// Each result is checked, and the summary goes to stdout, CSV and/or JSON.
+// With -C the timed runs are also measured with perf_event_open, and the
+// counters, swaps and allocations are reported next to the times.
+
+struct BenchResult {
+  char algorithm;
+  Distribution dist;
+  long n;
+  int max_val;
+  unsigned seed;
+  int threads;
+  int reps;
+  double min_ns;
+  double median_ns;
+  double p95_ns;
+  double mean_ns;
+  double elements_per_sec;
+  long long comparisons;  // -1 when the mode doesn't count them
+  long long swaps;        // likewise
+  long long alloc_bytes;  // operator new, one run
+  long long allocs;
+  long long peak_bytes;   // most bytes allocated at once during one run
+  long long peak_rss;     // most the resident set grew during a timed run, -1 if unknown
+  PerfSample perf;        // mean per timed run, -1 without -C or the event
+};
+
+
+// Parses 1e6 or 1000000 style sizes; false unless all of s is a number.
+bool parse_size(const std::string & s, long & n) {
+  size_t used = 0;
+  double value;
+  try {
+    value = std::stod(s, &used);
+  } catch (const std::exception &) {
+    return false;
+  }
+  if (used != s.size()) return false;
+  n = static_cast<long>(value);
+  return true;
+}
+
+
+// Sizes are "N", "A,B,C" or "A..B" (powers of ten from A to B). A range
+// starts at 1 at the least, or it would never reach B; listed sizes must
+// be at least 1.
+bool parse_sizes(const std::string & spec, std::vector<long> & sizes) {
+  sizes.clear();
+  size_t dots = spec.find("..");
+
+  if (dots != std::string::npos) {
+    long lo, hi;
+    if (!parse_size(spec.substr(0, dots), lo) || !parse_size(spec.substr(dots + 2), hi)) return false;
+    lo = std::max(1L, lo);
+    if (lo > hi) return false;
+    for (long n = lo; n <= hi; n *= 10) {
+      sizes.push_back(n);
+    }
+    return true;
+  }
+
+  size_t start = 0;
+  while (start <= spec.size()) {
+    size_t comma = spec.find(',', start);
+    if (comma == std::string::npos) comma = spec.size();
+    long n;
+    if (!parse_size(spec.substr(start, comma - start), n) || n < 1) return false;
+    sizes.push_back(n);
+    start = comma + 1;
+  }
+  return true;
+}
+
+
+// Thread and run counts are "N", "A,B,C" or "A..B" (doubling from A,
+// then B).
+std::vector<int> parse_counts(const std::string & spec) {
+  std::vector<int> counts;
+  size_t dots = spec.find("..");
+
+  if (dots != std::string::npos) {
+    int lo = std::max(1, std::stoi(spec.substr(0, dots)));
+    int hi = std::stoi(spec.substr(dots + 2));
+    for (int t = lo; t < hi; t *= 2) {
+      counts.push_back(t);
+    }
+    counts.push_back(hi);
+    return counts;
+  }
+
+  size_t start = 0;
+  while (start <= spec.size()) {
+    size_t comma = spec.find(',', start);
+    if (comma == std::string::npos) comma = spec.size();
+    counts.push_back(std::stoi(spec.substr(start, comma - start)));
+    start = comma + 1;
+  }
+  return counts;
+}
+
+
+// Nearest-rank percentile of sorted samples: the smallest sample with at
+// least p% of them at or below it, as percentile_rank in select.h.
+double percentile(const std::vector<double> & sorted, double p) {
+  size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+  if (rank < 1) rank = 1;
+  if (rank > sorted.size()) rank = sorted.size();
+  return sorted[rank - 1];
+}
+
+
+BenchResult run_benchmark(char algorithm, Distribution dist, const std::vector<int> & input,
+                          int max_val, unsigned seed, int threads,
+                          int warmups, int reps, bool counters) {
+  std::vector<double> samples;
+  SortCounts counts;
+  AllocStats before, after;
+  long long rss_growth = -1;
+
+  // Opened before the runs so that their threads inherit the counters,
+  // and enabled only while a timed run sorts.
+  std::unique_ptr<PerfCounters> perf;
+  if (counters) perf = std::make_unique<PerfCounters>();
+
+  for (int r = 0; r < warmups + reps; r++) {
+    std::vector<int> a = input;
+    bool timed = r >= warmups;
+
+    reset_alloc_peak();
+    before = alloc_stats();
+    long long rss_before = timed && reset_peak_rss() ? current_rss() : -1;
+    if (perf && timed) perf->start();
+    auto start = std::chrono::steady_clock::now();
+    run_sort(algorithm, a, threads);
+    auto stop = std::chrono::steady_clock::now();
+    if (perf && timed) perf->stop();
+    after = alloc_stats();
+    counts = last_counts();
+    if (rss_before >= 0) rss_growth = std::max(rss_growth, peak_rss() - rss_before);
+
+    if (!std::is_sorted(a.begin(), a.end())) {
+      std::cerr << "ERROR: " << algorithm_name(algorithm) << " left n = "
+                << input.size() << " unsorted\n";
+      exit(1);
+    }
+    if (timed) {
+      samples.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+    }
+  }
+
+  std::sort(samples.begin(), samples.end());
+  double sum = 0;
+  for (double s : samples) sum += s;
+
+  BenchResult res;
+  res.algorithm = algorithm;
+  res.dist = dist;
+  res.n = input.size();
+  res.max_val = max_val;
+  res.seed = seed;
+  res.threads = threads;
+  res.reps = reps;
+  res.min_ns = samples.front();
+  res.median_ns = percentile(samples, 50);
+  res.p95_ns = percentile(samples, 95);
+  res.mean_ns = sum / samples.size();
+  res.elements_per_sec = res.n / (res.median_ns * 1e-9);
+  res.comparisons = counts.comparisons;
+  res.swaps = counts.swaps;
+  res.alloc_bytes = after.bytes - before.bytes;
+  res.allocs = after.calls - before.calls;
+  res.peak_bytes = after.peak - before.live;
+  res.peak_rss = rss_growth;
+
+  PerfSample total = perf ? perf->read() : PerfSample();
+  for (int e = 0; e < PERF_EVENTS; e++) {
+    res.perf.value[e] = perf && total.value[e] >= 0 ? total.value[e] / reps : -1;
+  }
+  return res;
+}
+
+
+void write_csv(const std::string & path, const std::vector<BenchResult> & results) {
+  std::ofstream out(path);
+  out << "algorithm,name,distribution,n,max,seed,threads,reps,min_ns,median_ns,p95_ns,mean_ns,elements_per_sec,comparisons,swaps,alloc_bytes,allocs,peak_bytes,peak_rss";
+  for (int e = 0; e < PERF_EVENTS; e++) out << "," << perf_event_name(e);
+  out << "\n" << std::fixed << std::setprecision(0);
+  for (const BenchResult & r : results) {
+    out << r.algorithm << "," << algorithm_name(r.algorithm) << "," << distribution_name(r.dist) << "," << r.n << ","
+        << r.max_val << "," << r.seed << "," << r.threads << "," << r.reps << ","
+        << r.min_ns << "," << r.median_ns << "," << r.p95_ns << "," << r.mean_ns << ","
+        << r.elements_per_sec << ",";
+    if (r.comparisons >= 0) out << r.comparisons;
+    out << ",";
+    if (r.swaps >= 0) out << r.swaps;
+    out << "," << r.alloc_bytes << "," << r.allocs << "," << r.peak_bytes << ",";
+    if (r.peak_rss >= 0) out << r.peak_rss;
+    for (int e = 0; e < PERF_EVENTS; e++) {
+      out << ",";
+      if (r.perf.value[e] >= 0) out << r.perf.value[e];
+    }
+    out << "\n";
+  }
+}
+
+
+// A count, or null when it wasn't measured.
+void json_count(std::ofstream & out, long long count) {
+  if (count >= 0) {
+    out << count;
+  } else {
+    out << "null";
+  }
+}
+
+
+void write_json(const std::string & path, const std::vector<BenchResult> & results) {
+  std::ofstream out(path);
+  out << std::fixed << std::setprecision(0) << "[\n";
+  for (size_t i = 0; i < results.size(); i++) {
+    const BenchResult & r = results[i];
+    out << "  {\"algorithm\": \"" << r.algorithm << "\", \"name\": \"" << algorithm_name(r.algorithm)
+        << "\", \"distribution\": \"" << distribution_name(r.dist) << "\", \"n\": " << r.n << ", \"max\": " << r.max_val << ", \"seed\": " << r.seed
+        << ", \"threads\": " << r.threads << ", \"reps\": " << r.reps
+        << ", \"min_ns\": " << r.min_ns << ", \"median_ns\": " << r.median_ns
+        << ", \"p95_ns\": " << r.p95_ns << ", \"mean_ns\": " << r.mean_ns
+        << ", \"elements_per_sec\": " << r.elements_per_sec << ", \"comparisons\": ";
+    json_count(out, r.comparisons);
+    out << ", \"swaps\": ";
+    json_count(out, r.swaps);
+    out << ", \"alloc_bytes\": " << r.alloc_bytes << ", \"allocs\": " << r.allocs
+        << ", \"peak_bytes\": " << r.peak_bytes << ", \"peak_rss\": ";
+    json_count(out, r.peak_rss);
+    for (int e = 0; e < PERF_EVENTS; e++) {
+      out << ", \"" << perf_event_name(e) << "\": ";
+      json_count(out, r.perf.value[e]);
+    }
+    out << "}"
+        << (i + 1 < results.size() ? ",\n" : "\n");
+  }
+  out << "]\n";
+}
+
+
+// results.md table: one row per (distribution, size), median ms per algorithm.
+void print_markdown(const std::string & algorithms, const std::vector<Distribution> & dists,
+                    const std::vector<long> & sizes, const std::vector<BenchResult> & results) {
+  std::cout << "| Input | n |";
+  for (char a : algorithms) std::cout << " ```" << algorithm_name(a) << "``` |";
+  std::cout << "\n|---|---|";
+  for (size_t i = 0; i < algorithms.size(); i++) std::cout << "---|";
+  std::cout << "\n" << std::fixed << std::setprecision(2);
+
+  for (Distribution d : dists) {
+    for (long n : sizes) {
+      std::cout << "| " << distribution_name(d) << " | " << n << " |";
+      for (char a : algorithms) {
+        for (const BenchResult & r : results) {
+          if (r.algorithm == a && r.dist == d && r.n == n) std::cout << " " << r.median_ns / 1e6 << " ms |";
+        }
+      }
+      std::cout << "\n";
+    }
+  }
+}
+
+
+// Scaling table: one row per (algorithm, distribution, size), median ms
+// and speedup over the first thread count in each column.
+void print_scaling(const std::string & algorithms, const std::vector<Distribution> & dists,
+                   const std::vector<long> & sizes, const std::vector<int> & thread_counts,
+                   const std::vector<BenchResult> & results) {
+  std::cout << "| Algorithm | Input | n |";
+  for (int t : thread_counts) std::cout << " " << t << (t == 1 ? " thread" : " threads") << " |";
+  std::cout << "\n|---|---|---|";
+  for (size_t i = 0; i < thread_counts.size(); i++) std::cout << "---|";
+  std::cout << "\n" << std::fixed << std::setprecision(2);
+
+  for (char a : algorithms) {
+    for (Distribution d : dists) {
+      for (long n : sizes) {
+        std::cout << "| ```" << algorithm_name(a) << "``` | " << distribution_name(d) << " | " << n << " |";
+        double base = 0;
+        for (int t : thread_counts) {
+          for (const BenchResult & r : results) {
+            if (r.algorithm != a || r.dist != d || r.n != n || r.threads != t) continue;
+            if (base == 0) base = r.median_ns;
+            std::cout << " " << r.median_ns / 1e6 << " ms (" << base / r.median_ns << "x) |";
+          }
+        }
+        std::cout << "\n";
+      }
+    }
+  }
+}
+
+
+// -k: times the merge of k sorted runs cut from input, for each k, with
+// the same warmups and repetitions as the sorts. "first block" is how long
+// the streaming merge takes to hand out its first KWAY_BLOCK elements.
+void run_kway_benchmark(Distribution dist, const std::vector<int> & input, const std::vector<int> & ks,
+                        int warmups, int reps) {
+  size_t n = input.size();
+  std::cout << "\nk-way merge, " << distribution_name(dist) << ", n = " << n << "\n"
+            << "| k | median ms | Melem/s | ns/element | first block us |\n|---|---|---|---|---|\n"
+            << std::fixed << std::setprecision(2);
+
+  for (int k : ks) {
+    std::vector<std::vector<int>> runs(k);
+    for (int r = 0; r < k; r++) {
+      runs[r].assign(input.begin() + n * r / k, input.begin() + n * (r + 1) / k);
+      std::sort(runs[r].begin(), runs[r].end());
+    }
+
+    std::vector<double> samples, first;
+    std::vector<int> out;
+    for (int r = 0; r < warmups + reps; r++) {
+      auto start = std::chrono::steady_clock::now();
+      kway_merge(runs, out);
+      auto stop = std::chrono::steady_clock::now();
+
+      int block[KWAY_BLOCK];
+      auto first_start = std::chrono::steady_clock::now();
+      KWayMerge stream(runs);
+      stream.read(block, KWAY_BLOCK);
+      auto first_stop = std::chrono::steady_clock::now();
+
+      if (out.size() != n || !std::is_sorted(out.begin(), out.end())) {
+        std::cerr << "ERROR: k-way merge of " << k << " runs is wrong\n";
+        exit(1);
+      }
+      if (r >= warmups) {
+        samples.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+        first.push_back(std::chrono::duration<double, std::nano>(first_stop - first_start).count());
+      }
+    }
+    std::sort(samples.begin(), samples.end());
+    std::sort(first.begin(), first.end());
+
+    double median = percentile(samples, 50);
+    std::cout << "| " << k << " | " << median / 1e6 << " | " << n / (median * 1e-3) << " | "
+              << median / n << " | " << percentile(first, 50) / 1e3 << " |\n";
+  }
+}
+
+
+// -S: times the string sorts against std::sort on the same strings, with
+// the same warmups and repetitions as the int sorts. The std::sort on
+// std::string moves the strings; the rest move 16-byte views or indices.
+void run_string_benchmark(StringKind kind, long n, unsigned seed, int warmups, int reps) {
+  std::vector<std::string> strs;
+  generate_strings(strs, n, kind, seed);
+  std::vector<std::string_view> views(strs.begin(), strs.end());
+  std::vector<std::string_view> expected = views;
+  std::sort(expected.begin(), expected.end());
+
+  std::cout << "\nstring sorts, " << string_kind_name(kind) << ", n = " << n << "\n"
+            << "| Algorithm | median ms | Melem/s | ns/element |\n|---|---|---|---|\n"
+            << std::fixed << std::setprecision(2);
+
+  const char * names[] = {"std::sort strings", "std::sort views", "multikey quicksort",
+                          "msd radix", "string argsort"};
+  for (int a = 0; a < 5; a++) {
+    std::vector<double> samples;
+    for (int r = 0; r < warmups + reps; r++) {
+      std::vector<std::string> copy;
+      std::vector<std::string_view> out;
+      std::vector<uint32_t> perm;
+      if (a == 0) {
+        copy = strs;
+      } else {
+        out = views;
+      }
+
+      auto start = std::chrono::steady_clock::now();
+      switch (a) {
+      case 0: std::sort(copy.begin(), copy.end()); break;
+      case 1: std::sort(out.begin(), out.end()); break;
+      case 2: multikey_quicksort(out); break;
+      case 3: msd_radix_sort(out); break;
+      case 4: string_argsort(strs, perm); break;
+      }
+      auto stop = std::chrono::steady_clock::now();
+
+      if (a == 0) {
+        out.assign(copy.begin(), copy.end());
+      } else if (a == 4) {
+        for (long i = 0; i < n; i++) {
+          out[i] = views[perm[i]];
+        }
+      }
+      if (out != expected) {
+        std::cerr << "ERROR: " << names[a] << " is not sorted\n";
+        exit(1);
+      }
+      if (r >= warmups) {
+        samples.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+      }
+    }
+    std::sort(samples.begin(), samples.end());
+
+    double median = percentile(samples, 50);
+    std::cout << "| " << names[a] << " | " << median / 1e6 << " | " << n / (median * 1e-3) << " | "
+              << median / n << " |\n";
+  }
+}
+
+
+// -R: a record table, sorted by key two ways. As an array of 64-byte
+// structs, moved whole by std::stable_sort; and as structure-of-arrays
+// columns, where argsort orders the key column and gather applies the
+// permutation to each column. Both must give the same rows in the same order.
+struct Record {
+  int key;
+  int id;
+  double score;
+  char name[48];
+};
+
+void run_record_benchmark(Distribution dist, const std::vector<int> & keys, int threads,
+                          int warmups, int reps) {
+  size_t n = keys.size();
+  std::vector<Record> records(n);
+  std::vector<int> ids(n);
+  std::vector<double> scores(n);
+  std::vector<std::string> names(n);
+  for (size_t i = 0; i < n; i++) {
+    names[i] = "row-" + std::to_string(i);
+    records[i].key = keys[i];
+    records[i].id = ids[i] = static_cast<int>(i);
+    records[i].score = scores[i] = i * 0.5;
+    snprintf(records[i].name, sizeof(records[i].name), "%s", names[i].c_str());
+  }
+
+  std::cout << "\nrecord table, " << distribution_name(dist) << ", n = " << n << ", " << threads
+            << " threads\n| Algorithm | median ms | Melem/s |\n|---|---|---|\n"
+            << std::fixed << std::setprecision(2);
+
+  std::vector<Record> expected = records;
+  std::stable_sort(expected.begin(), expected.end(),
+                   [](const Record & x, const Record & y) { return x.key < y.key; });
+
+  const char * labels[] = {"std::stable_sort structs", "argsort", "argsort + gather 4 columns"};
+  for (int a = 0; a < 3; a++) {
+    std::vector<double> samples;
+    for (int r = 0; r < warmups + reps; r++) {
+      std::vector<Record> table;
+      std::vector<uint32_t> perm;
+      std::vector<int> out_keys, out_ids;
+      std::vector<double> out_scores;
+      std::vector<std::string> out_names;
+      if (a == 0) table = records;
+
+      auto start = std::chrono::steady_clock::now();
+      if (a == 0) {
+        std::stable_sort(table.begin(), table.end(),
+                         [](const Record & x, const Record & y) { return x.key < y.key; });
+      } else {
+        argsort(keys, perm);
+        if (a == 2) {
+          gather(keys, perm, out_keys, threads);
+          gather(ids, perm, out_ids, threads);
+          gather(scores, perm, out_scores, threads);
+          gather(names, perm, out_names, threads);
+        }
+      }
+      auto stop = std::chrono::steady_clock::now();
+
+      bool ok = true;
+      for (size_t i = 0; i < n && ok; i++) {
+        const Record & e = expected[i];
+        if (a == 0) {
+          ok = table[i].id == e.id && table[i].key == e.key && strcmp(table[i].name, e.name) == 0;
+        } else if (a == 1) {
+          ok = static_cast<int>(perm[i]) == e.id;
+        } else {
+          ok = out_keys[i] == e.key && out_ids[i] == e.id && out_scores[i] == e.score && out_names[i] == e.name;
+        }
+      }
+      if (!ok) {
+        std::cerr << "ERROR: " << labels[a] << " does not match std::stable_sort\n";
+        exit(1);
+      }
+      if (r >= warmups) {
+        samples.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+      }
+    }
+    std::sort(samples.begin(), samples.end());
+
+    double median = percentile(samples, 50);
+    std::cout << "| " << labels[a] << " | " << median / 1e6 << " | " << n / (median * 1e-3) << " |\n";
+  }
+}
+
+
+// count / n, or n/a when it wasn't measured.
+void print_per_element(long long count, long n) {
+  if (count < 0) {
+    std::cout << " n/a |";
+  } else {
+    std::cout << " " << static_cast<double>(count) / n << " |";
+  }
+}
+
+
+// Counters table for -C, one row per result. Everything but IPC and page
+// faults is per element; allocations and peak RSS growth are for one run.
+void print_counters(const std::vector<BenchResult> & results) {
+  std::cout << "| Algorithm | Input | n | threads | IPC | branch misses/n | L1D misses/n | LLC misses/n"
+            << " | page faults | cmp/n | swaps/n | alloc B/n | peak B/n | peak RSS B/n |\n"
+            << "|---|---|---|---|---|---|---|---|---|---|---|---|---|---|\n"
+            << std::fixed << std::setprecision(2);
+
+  for (const BenchResult & r : results) {
+    std::cout << "| ```" << algorithm_name(r.algorithm) << "``` | " << distribution_name(r.dist) << " | "
+              << r.n << " | " << r.threads << " |";
+    long long cycles = r.perf.value[PERF_CYCLES];
+    long long instructions = r.perf.value[PERF_INSTRUCTIONS];
+    if (cycles > 0 && instructions >= 0) {
+      std::cout << " " << static_cast<double>(instructions) / cycles << " |";
+    } else {
+      std::cout << " n/a |";
+    }
+    print_per_element(r.perf.value[PERF_BRANCH_MISSES], r.n);
+    print_per_element(r.perf.value[PERF_L1D_MISSES], r.n);
+    print_per_element(r.perf.value[PERF_LLC_MISSES], r.n);
+    print_per_element(r.perf.value[PERF_PAGE_FAULTS], 1);
+    print_per_element(r.comparisons, r.n);
+    print_per_element(r.swaps, r.n);
+    print_per_element(r.alloc_bytes, r.n);
+    print_per_element(r.peak_bytes, r.n);
+    print_per_element(r.peak_rss, r.n);
+    std::cout << "\n";
+  }
+}
+
+
+void print_help(char * command_name) {
+  std::cout << "Usage: " << command_name;
+  std::cout << " [-h|-a ALGORITHMS|-s SIZES|-d DISTRIBUTIONS|-m N|-t N|-r N|-n N|-w N|-c FILE|-j FILE|-M|-C|-k RUNS|-S KINDS|-R]\n\n";
+  std::cout << " -a ALGORITHMS   sort mode letters from sorts -h, e.g. riSb, or auto (default: i)\n";
+  std::cout << " -s SIZES        N, A,B,C or A..B by powers of ten, e.g. 1e3..1e7 (default: 1e3..1e6)\n";
+  std::cout << " -d DISTRIBUTIONS comma separated, from uniform, sorted, reverse, nearly,\n";
+  std::cout << "                 fewunique, organpipe, zipf, sawtooth (default: uniform)\n";
+  std::cout << " -m MAX_ELEMENT_SIZE (default: 1000000000)\n";
+  std::cout << " -t THREADS      N, A,B,C or A..B doubling, e.g. 1..8 for a scaling\n";
+  std::cout << "                 table (default: all cores)\n";
+  std::cout << " -r SEED         input seed (default: 42)\n";
+  std::cout << " -n REPS         timed repetitions (default: 11)\n";
+  std::cout << " -w WARMUPS      untimed runs first (default: 2)\n";
+  std::cout << " -c FILE         write CSV\n";
+  std::cout << " -j FILE         write JSON\n";
+  std::cout << " -M              print a results.md table of medians (and of scaling\n";
+  std::cout << "                 when -t lists several thread counts)\n";
+  std::cout << " -C              measure the timed runs with perf_event_open (cycles,\n";
+  std::cout << "                 instructions, branch and cache misses, page faults) and\n";
+  std::cout << "                 print a table of counters, swaps and allocations\n";
+  std::cout << " -k RUNS         instead of sorting, time k-way merges of RUNS sorted runs of\n";
+  std::cout << "                 each input: N, A,B,C or A..B doubling, e.g. 2..1024\n";
+  std::cout << " -S KINDS        instead of sorting ints, time the string sorts against\n";
+  std::cout << "                 std::sort on each size of strings, comma separated from\n";
+  std::cout << "                 dna, names, urls\n";
+  std::cout << " -R              instead of sorting ints, sort a table of records by key as\n";
+  std::cout << "                 64-byte structs (std::stable_sort) and as columns (argsort,\n";
+  std::cout << "                 then gather), and check that both agree\n";
+}
+
+
+int main(int argc, char * argv[]) {
+  std::string algorithms = "i";
+  std::string size_spec = "1e3..1e6";
+  std::string dist_spec = "uniform";
+  int max_val = 1000000000;
+  std::string thread_spec = std::to_string(std::thread::hardware_concurrency());
+  unsigned seed = 42;
+  int reps = 11;
+  int warmups = 2;
+  std::string csv_path, json_path;
+  bool markdown = false;
+  bool counters = false;
+  std::string kway_spec;
+  std::string string_spec;
+  bool records = false;
+
+  static struct option long_options[] = {
+    {"help", no_argument, nullptr, 'h'},
+    {"algorithms", required_argument, nullptr, 'a'},
+    {"sizes", required_argument, nullptr, 's'},
+    {"distributions", required_argument, nullptr, 'd'},
+    {"max", required_argument, nullptr, 'm'},
+    {"threads", required_argument, nullptr, 't'},
+    {"seed", required_argument, nullptr, 'r'},
+    {"reps", required_argument, nullptr, 'n'},
+    {"warmups", required_argument, nullptr, 'w'},
+    {"csv", required_argument, nullptr, 'c'},
+    {"json", required_argument, nullptr, 'j'},
+    {"markdown", no_argument, nullptr, 'M'},
+    {"counters", no_argument, nullptr, 'C'},
+    {"kway", required_argument, nullptr, 'k'},
+    {"strings", required_argument, nullptr, 'S'},
+    {"records", no_argument, nullptr, 'R'},
+    {nullptr, 0, nullptr, 0}
+  };
+
+  int c;
+  while ((c = getopt_long(argc, argv, "ha:s:d:m:t:r:n:w:c:j:MCk:S:R", long_options, nullptr)) != -1) {
+    switch (c) {
+    case 'h' :
+      print_help(argv[0]);
+      exit(0);
+    case 'a' :
+      // "auto" is the one mode with a name rather than a letter.
+      algorithms = optarg;
+      for (size_t p; (p = algorithms.find("auto")) != std::string::npos;) {
+        algorithms.replace(p, 4, "a");
+      }
+      break;
+    case 's' :
+      size_spec = optarg;
+      break;
+    case 'd' :
+      dist_spec = optarg;
+      break;
+    case 'm' :
+      max_val = std::stoi(optarg);
+      break;
+    case 't' :
+      thread_spec = optarg;
+      break;
+    case 'r' :
+      seed = std::stoul(optarg);
+      break;
+    case 'n' :
+      reps = std::max(1, std::stoi(optarg));
+      break;
+    case 'w' :
+      warmups = std::max(0, std::stoi(optarg));
+      break;
+    case 'c' :
+      csv_path = optarg;
+      break;
+    case 'j' :
+      json_path = optarg;
+      break;
+    case 'M' :
+      markdown = true;
+      break;
+    case 'C' :
+      counters = true;
+      break;
+    case 'k' :
+      kway_spec = optarg;
+      break;
+    case 'S' :
+      string_spec = optarg;
+      break;
+    case 'R' :
+      records = true;
+      break;
+    default :
+      print_help(argv[0]);
+      exit(1);
+    }
+  }
+
+  std::vector<long> sizes;
+  if (!parse_sizes(size_spec, sizes)) {
+    std::cerr << "Bad sizes " << size_spec << "\n";
+    print_help(argv[0]);
+    exit(1);
+  }
+  std::vector<int> thread_counts = parse_counts(thread_spec);
+  int max_threads = *std::max_element(thread_counts.begin(), thread_counts.end());
+  std::vector<Distribution> dists;
+
+  size_t start = 0;
+  while (start <= dist_spec.size()) {
+    size_t comma = dist_spec.find(',', start);
+    if (comma == std::string::npos) comma = dist_spec.size();
+
+    Distribution d;
+    if (!parse_distribution(dist_spec.substr(start, comma - start), d)) {
+      std::cerr << "Unknown distribution " << dist_spec.substr(start, comma - start) << "\n";
+      return 1;
+    }
+    dists.push_back(d);
+    start = comma + 1;
+  }
+  std::vector<BenchResult> results;
+
+  if (!string_spec.empty()) {
+    std::vector<StringKind> kinds;
+    size_t from = 0;
+    while (from <= string_spec.size()) {
+      size_t comma = string_spec.find(',', from);
+      if (comma == std::string::npos) comma = string_spec.size();
+
+      StringKind k;
+      if (!parse_string_kind(string_spec.substr(from, comma - from), k)) {
+        std::cerr << "Unknown string kind " << string_spec.substr(from, comma - from) << "\n";
+        return 1;
+      }
+      kinds.push_back(k);
+      from = comma + 1;
+    }
+    for (StringKind k : kinds) {
+      for (long n : sizes) {
+        run_string_benchmark(k, n, seed, warmups, reps);
+      }
+    }
+    return 0;
+  }
+
+  if (records) {
+    for (Distribution d : dists) {
+      for (long n : sizes) {
+        std::vector<int> input;
+        generate(input, n, max_val, d, seed, max_threads);
+        run_record_benchmark(d, input, max_threads, warmups, reps);
+      }
+    }
+    return 0;
+  }
+
+  if (!kway_spec.empty()) {
+    std::vector<int> ks = parse_counts(kway_spec);
+    for (Distribution d : dists) {
+      for (long n : sizes) {
+        std::vector<int> input;
+        generate(input, n, max_val, d, seed, max_threads);
+        run_kway_benchmark(d, input, ks, warmups, reps);
+      }
+    }
+    return 0;
+  }
+
+  for (char a : algorithms) {
+    if (std::string(algorithm_name(a)) == "unknown") {
+      std::cerr << "Unknown algorithm " << a << "\n";
+      return 1;
+    }
+  }
+
+  std::cout << std::left << std::setw(18) << "algorithm" << std::setw(11) << "input" << std::setw(12) << "n"
+            << std::setw(9) << "threads"
+            << std::setw(14) << "min ms" << std::setw(14) << "median ms"
+            << std::setw(14) << "p95 ms" << std::setw(10) << "Melem/s" << std::setw(12) << "peak RSS MB"
+            << "cmp/n\n";
+
+  for (Distribution d : dists) {
+    for (long n : sizes) {
+      // Same input for every algorithm at this size.
+      std::vector<int> input;
+      generate(input, n, max_val, d, seed, max_threads);
+
+      for (int threads : thread_counts) {
+        for (char a : algorithms) {
+          BenchResult r = run_benchmark(a, d, input, max_val, seed, threads, warmups, reps, counters);
+          results.push_back(r);
+
+          std::cout << std::fixed << std::setprecision(3) << std::left
+                    << std::setw(18) << algorithm_name(a) << std::setw(11) << distribution_name(d)
+                    << std::setw(12) << n << std::setw(9) << threads
+                    << std::setw(14) << r.min_ns / 1e6 << std::setw(14) << r.median_ns / 1e6
+                    << std::setw(14) << r.p95_ns / 1e6 << std::setw(10) << r.elements_per_sec / 1e6
+                    << std::setw(12) << (r.peak_rss >= 0 ? std::to_string(r.peak_rss >> 20) : "n/a");
+          if (r.comparisons >= 0) std::cout << std::setprecision(2) << static_cast<double>(r.comparisons) / n;
+          std::cout << "\n";
+          if (a == 'a') std::cout << "  auto picked " << last_auto_choice() << "\n";
+        }
+      }
+    }
+  }
+
+  if (counters) {
+    if (!PerfCounters().available()) {
+      std::cerr << "Note: perf_event_open is not available here (see /proc/sys/kernel/perf_event_paranoid)\n";
+    }
+    std::cout << "\n";
+    print_counters(results);
+  }
+
+  if (!csv_path.empty()) write_csv(csv_path, results);
+  if (!json_path.empty()) write_json(json_path, results);
+  if (markdown) {
+    std::cout << "\n";
+    if (thread_counts.size() > 1) {
+      print_scaling(algorithms, dists, sizes, thread_counts, results);
+    } else {
+      print_markdown(algorithms, dists, sizes, results);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,88 @@
+#ifndef BLOCK_PARTITION_H
+#define BLOCK_PARTITION_H
+
+#include <vector>
+#include <utility>
+
+#include "introsort.h"
+
+
+/* BlockQuicksort-style partition (Edelkamp & Weiss).
+   Instead of branching on every comparison, each side scans a block of
+   BLOCK_SIZE keys and records the offsets of the ones that are on the
+   wrong side; the offset counter is bumped by the comparison result, so
+   the scan has no data-dependent branch. The recorded pairs are then
+   swapped in a batch. Both sides treat keys equal to the pivot as
+   misplaced, like the Hoare partition in introsort.h, so duplicates still
+   split evenly. */
+
+const int BLOCK_SIZE = 64;
+
+
+inline int block_partition(std::vector<int> & arr, int l, int h) {
+  choose_pivot(arr, l, h);
+
+  int pivot = arr[l];
+  int * first = arr.data() + l + 1;
+  int * last = arr.data() + h + 1;
+
+  unsigned char offsets_l[BLOCK_SIZE], offsets_r[BLOCK_SIZE];
+  int num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+
+  while (last - first > 2 * BLOCK_SIZE) {
+    if (num_l == 0) {
+      start_l = 0;
+      for (int i = 0; i < BLOCK_SIZE; i++) {
+        offsets_l[num_l] = i;
+        num_l += !(first[i] < pivot);
+      }
+    }
+    if (num_r == 0) {
+      start_r = 0;
+      for (int i = 0; i < BLOCK_SIZE; i++) {
+        offsets_r[num_r] = i;
+        num_r += !(pivot < last[-1 - i]);
+      }
+    }
+
+    int num = std::min(num_l, num_r);
+    for (int k = 0; k < num; k++) {
+      std::swap(first[offsets_l[start_l + k]], last[-1 - offsets_r[start_r + k]]);
+    }
+    num_l -= num;
+    num_r -= num;
+    start_l += num;
+    start_r += num;
+
+    if (num_l == 0) first += BLOCK_SIZE;
+    if (num_r == 0) last -= BLOCK_SIZE;
+  }
+
+  // At most 2 * BLOCK_SIZE keys left between first and last, including any
+  // block whose offsets were not used up. Everything left of first is
+  // <= pivot and everything from last on is >= pivot, so a plain Hoare
+  // scan finishes the job.
+  int * i = first;
+  int * j = last - 1;
+  while (true) {
+    while (i <= j && *i < pivot) i++;
+    while (i <= j && pivot < *j) j--;
+    if (i >= j) break;
+    std::swap(*i, *j);
+    i++;
+    j--;
+  }
+
+  int p = (i - arr.data()) - 1;
+  std::swap(arr[l], arr[p]);
+  return p;
+}
+
+
+// Introsort driver with the block partition in place of the Hoare one.
+inline void block_qsort(std::vector<int> & arr) {
+  if (arr.size() < 2) return;
+  introsort_range(arr, 0, arr.size() - 1, block_partition);
+}
+
+#endif // BLOCK_PARTITION_H
@@ -0,0 +1,286 @@
+#ifndef DATAGEN_H
+#define DATAGEN_H
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+
+/* Dataset generator for the sort and hashing benchmarks.
+   Randomness comes from Philox4x32-10, a counter-based generator: the
+   value at index i is a pure function of (seed, i). Any thread can fill
+   any slice of the output without sharing generator state, and the same
+   seed gives the same data for any thread count. Header only, so other
+   benchmarks can include it as is. */
+
+enum Distribution {
+  UNIFORM,        // uniform over [0, max), like makeVec
+  SORTED,         // ascending ramp over [0, max)
+  REVERSE,        // descending ramp
+  NEARLY_SORTED,  // ramp with 1% of the keys replaced at random
+  FEW_UNIQUE,     // 16 distinct keys
+  ORGAN_PIPE,     // ascending to the middle, then descending
+  ZIPF,           // Zipfian ranks (s = 1), key 0 the most common
+  SAWTOOTH,       // 16 ascending ramps back to back
+  DISTRIBUTION_COUNT
+};
+
+
+inline const char * distribution_name(Distribution d) {
+  static const char * names[] = {"uniform", "sorted", "reverse", "nearly", "fewunique",
+                                 "organpipe", "zipf", "sawtooth"};
+  return d < DISTRIBUTION_COUNT ? names[d] : "unknown";
+}
+
+
+inline bool parse_distribution(const std::string & name, Distribution & d) {
+  for (int i = 0; i < DISTRIBUTION_COUNT; i++) {
+    if (name == distribution_name(static_cast<Distribution>(i))) {
+      d = static_cast<Distribution>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+
+// Philox4x32-10 (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3").
+// Counter (c0, c1, c2) and a 64-bit key, four 32-bit outputs.
+inline void philox4x32(uint32_t c0, uint32_t c1, uint32_t c2, uint64_t key, uint32_t out[4]) {
+  uint32_t x0 = c0, x1 = c1, x2 = c2, x3 = 0;
+  uint32_t k0 = static_cast<uint32_t>(key), k1 = static_cast<uint32_t>(key >> 32);
+
+  for (int round = 0; round < 10; round++) {
+    uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * x0;
+    uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * x2;
+    uint32_t y0 = static_cast<uint32_t>(p1 >> 32) ^ x1 ^ k0;
+    uint32_t y1 = static_cast<uint32_t>(p1);
+    uint32_t y2 = static_cast<uint32_t>(p0 >> 32) ^ x3 ^ k1;
+    uint32_t y3 = static_cast<uint32_t>(p0);
+    x0 = y0; x1 = y1; x2 = y2; x3 = y3;
+    k0 += 0x9E3779B9u;
+    k1 += 0xBB67AE85u;
+  }
+  out[0] = x0; out[1] = x1; out[2] = x2; out[3] = x3;
+}
+
+
+// 32 random bits for index i of stream (stream 0 is the main one).
+inline uint32_t random_at(uint64_t seed, uint64_t i, uint32_t stream = 0) {
+  uint32_t out[4];
+  philox4x32(static_cast<uint32_t>(i >> 2), static_cast<uint32_t>(i >> 34), stream, seed, out);
+  return out[i & 3];
+}
+
+
+// Maps 32 random bits onto [0, range) with a multiply instead of a modulo.
+inline int scale_to(uint32_t r, int range) {
+  return static_cast<int>((static_cast<uint64_t>(r) * static_cast<uint32_t>(range)) >> 32);
+}
+
+
+/* Zipf sampler over ranks 1..n by rejection-inversion (Hormann and
+   Derflinger), so it needs no table of n probabilities. Each attempt
+   draws from its own Philox stream, so the sample at index i stays a
+   function of (seed, i). */
+class ZipfSampler {
+public:
+  ZipfSampler(long n, double exponent) : n_(n), s_(exponent) {
+    h_x1_ = h_integral(1.5) - 1.0;
+    h_n_ = h_integral(n_ + 0.5);
+    shift_ = 2.0 - h_integral_inverse(h_integral(2.5) - h(2.0));
+  }
+
+  long sample(uint64_t seed, uint64_t i) const {
+    for (uint32_t attempt = 1; ; attempt++) {
+      double u01 = random_at(seed, i, attempt) * (1.0 / 4294967296.0);
+      double u = h_n_ + u01 * (h_x1_ - h_n_);
+      double x = h_integral_inverse(u);
+      long k = static_cast<long>(x + 0.5);
+      k = std::max(1L, std::min(k, n_));
+
+      if (k - x <= shift_ || u >= h_integral(k + 0.5) - h(k)) return k;
+    }
+  }
+
+private:
+  long n_;
+  double s_;
+  double h_x1_, h_n_, shift_;
+
+  double h(double x) const { return std::exp(-s_ * std::log(x)); }
+
+  double h_integral(double x) const {
+    double log_x = std::log(x);
+    return helper2((1.0 - s_) * log_x) * log_x;
+  }
+
+  double h_integral_inverse(double x) const {
+    double t = x * (1.0 - s_);
+    if (t < -1.0) t = -1.0;
+    return std::exp(helper1(t) * x);
+  }
+
+  // log1p(x) / x and expm1(x) / x, with series near 0 where s = 1.
+  static double helper1(double x) {
+    if (std::fabs(x) > 1e-8) return std::log1p(x) / x;
+    return 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+  }
+
+  static double helper2(double x) {
+    if (std::fabs(x) > 1e-8) return std::expm1(x) / x;
+    return 1.0 + x * 0.5 * (1.0 + x * (1.0 / 3.0) * (1.0 + 0.25 * x));
+  }
+};
+
+
+// Key at index i of n; all keys fall in [0, max_val). r is random_at(seed, i).
+inline int generate_at(Distribution d, uint64_t i, uint64_t n, int max_val,
+                       uint32_t r, uint64_t seed, const ZipfSampler * zipf) {
+  const int FEW = 16;
+
+  switch (d) {
+  case UNIFORM:
+    return scale_to(r, max_val);
+  case SORTED:
+    return static_cast<int>(i * max_val / n);
+  case REVERSE:
+    return static_cast<int>((n - 1 - i) * max_val / n);
+  case NEARLY_SORTED:
+    if (scale_to(random_at(seed, i, 1), 100) == 0) return scale_to(r, max_val);
+    return static_cast<int>(i * max_val / n);
+  case FEW_UNIQUE:
+    return static_cast<int>(static_cast<int64_t>(scale_to(r, FEW)) * max_val / FEW);
+  case ORGAN_PIPE: {
+    uint64_t half = (n + 1) / 2;
+    uint64_t pos = i < half ? i : n - 1 - i;
+    return static_cast<int>(pos * max_val / half);
+  }
+  case ZIPF:
+    return static_cast<int>(zipf->sample(seed, i) - 1);
+  case SAWTOOTH: {
+    uint64_t period = std::max<uint64_t>(1, (n + FEW - 1) / FEW);
+    return static_cast<int>((i % period) * max_val / period);
+  }
+  default:
+    return 0;
+  }
+}
+
+
+// Fills out with n keys of distribution d, split across threads.
+inline void generate(std::vector<int> & out, size_t n, int max_val, Distribution d,
+                     uint64_t seed, int threads = 1) {
+  out.resize(n);
+  if (n == 0) return;
+  if (max_val < 1) max_val = 1;
+  if (threads < 1) threads = 1;
+
+  ZipfSampler zipf(max_val, 1.0);
+  // Chunks start on a multiple of 4 so each Philox block is computed once.
+  size_t chunk = ((n + threads - 1) / threads + 3) & ~static_cast<size_t>(3);
+
+  auto fill = [&](size_t begin, size_t end) {
+    uint32_t block[4];
+    for (size_t i = begin; i < end; i++) {
+      if ((i & 3) == 0 || i == begin) {
+        philox4x32(static_cast<uint32_t>(i >> 2), static_cast<uint32_t>(i >> 34), 0, seed, block);
+      }
+      out[i] = generate_at(d, i, n, max_val, block[i & 3], seed, &zipf);
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (int t = 1; t < threads && t * chunk < n; t++) {
+    workers.emplace_back(fill, t * chunk, std::min(n, (t + 1) * chunk));
+  }
+  fill(0, std::min(n, chunk));
+  for (auto & w : workers) {
+    w.join();
+  }
+}
+
+
+// String datasets for the string sorts (bench -S), one Philox block per
+// string on stream 8.
+
+enum StringKind {
+  STRINGS_DNA,    // recognition sequences: 6 to 24 bases over ACGT
+  STRINGS_NAMES,  // "Surname, Given" from syllable tables, with repeats
+  STRINGS_URLS,   // one 26-byte URL prefix, then a 9-digit id
+  STRING_KIND_COUNT
+};
+
+
+inline const char * string_kind_name(StringKind k) {
+  static const char * names[] = {"dna", "names", "urls"};
+  return k < STRING_KIND_COUNT ? names[k] : "unknown";
+}
+
+
+inline bool parse_string_kind(const std::string & name, StringKind & k) {
+  for (int i = 0; i < STRING_KIND_COUNT; i++) {
+    if (name == string_kind_name(static_cast<StringKind>(i))) {
+      k = static_cast<StringKind>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+
+inline std::string generate_string_at(StringKind k, uint64_t i, uint64_t seed) {
+  static const char * SYLLABLES[32] = {
+    "an", "ber", "cal", "dor", "el", "fen", "gar", "hol", "is", "jor", "kel", "lin", "mar", "nor", "o", "per",
+    "quin", "ros", "sal", "tam", "ul", "ver", "wil", "xan", "yor", "zel", "ba", "che", "di", "fa", "go", "hu"};
+  static const char * GIVEN[32] = {
+    "Ada", "Ben", "Cara", "Dan", "Eve", "Finn", "Gail", "Hugo", "Ida", "Jon", "Kim", "Leo", "Mia", "Ned", "Ola",
+    "Pam", "Quinn", "Rae", "Sam", "Tess", "Uma", "Vic", "Wes", "Xia", "Yan", "Zoe", "Abe", "Bea", "Cy", "Di",
+    "Eli", "Fay"};
+
+  uint32_t r[4];
+  philox4x32(static_cast<uint32_t>(i), static_cast<uint32_t>(i >> 32), 8, seed, r);
+  std::string s;
+
+  switch (k) {
+  case STRINGS_DNA: {
+    int len = 6 + scale_to(r[0], 19);
+    uint64_t bases = static_cast<uint64_t>(r[1]) << 32 | r[2];
+    for (int b = 0; b < len; b++) {
+      s += "ACGT"[(bases >> (2 * b)) & 3];
+    }
+    break;
+  }
+  case STRINGS_NAMES: {
+    int syllables = 2 + (r[0] & 1);
+    for (int y = 0; y < syllables; y++) {
+      s += SYLLABLES[(r[1] >> (5 * y)) & 31];
+    }
+    s[0] = static_cast<char>(s[0] - 'a' + 'A');
+    s += ", ";
+    s += GIVEN[r[2] & 31];
+    break;
+  }
+  case STRINGS_URLS: {
+    std::string id = std::to_string(scale_to(r[0], 1000000000));
+    s = "https://example.com/users/" + std::string(9 - id.size(), '0') + id;
+    break;
+  }
+  default:
+    break;
+  }
+  return s;
+}
+
+
+inline void generate_strings(std::vector<std::string> & out, size_t n, StringKind k, uint64_t seed) {
+  out.resize(n);
+  for (size_t i = 0; i < n; i++) {
+    out[i] = generate_string_at(k, i, seed);
+  }
+}
+
+#endif // DATAGEN_H
@@ -0,0 +1,339 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <future>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "external_sort.h"
+#include "loser_tree.h"
+#include "radix_sort.h"
+
+
+namespace {
+
+// Past this, bigger blocks no longer speed up sequential I/O.
+const size_t EXT_MAX_BLOCK = size_t(32) << 20;
+
+
+size_t round_up(size_t bytes) {
+  return (bytes + EXT_IO_ALIGN - 1) & ~(EXT_IO_ALIGN - 1);
+}
+
+size_t round_down(size_t bytes) {
+  return bytes & ~(EXT_IO_ALIGN - 1);
+}
+
+
+// Page-aligned int buffer, as O_DIRECT requires.
+class AlignedBuffer {
+public:
+  explicit AlignedBuffer(size_t bytes = 0) {
+    if (bytes > 0 && posix_memalign(&p_, EXT_IO_ALIGN, round_up(bytes)) != 0) {
+      throw std::bad_alloc();
+    }
+  }
+  AlignedBuffer(AlignedBuffer && other) noexcept : p_(other.p_) { other.p_ = nullptr; }
+  AlignedBuffer & operator=(AlignedBuffer && other) noexcept {
+    std::swap(p_, other.p_);
+    return *this;
+  }
+  AlignedBuffer(const AlignedBuffer &) = delete;
+  AlignedBuffer & operator=(const AlignedBuffer &) = delete;
+  ~AlignedBuffer() { free(p_); }
+
+  int * data() const { return static_cast<int *>(p_); }
+
+private:
+  void * p_ = nullptr;
+};
+
+
+// Closes the descriptor, and unlinks the file too if it is a temporary.
+struct File {
+  int fd = -1;
+  std::string unlink_path;
+
+  ~File() {
+    if (fd >= 0) close(fd);
+    if (!unlink_path.empty()) unlink(unlink_path.c_str());
+  }
+};
+
+
+bool io_error(const std::string & what, const std::string & path) {
+  std::cerr << "ERROR: " << what << " " << path << ": " << strerror(errno) << "\n";
+  return false;
+}
+
+
+// Opens with O_DIRECT when asked, falling back to buffered I/O on file
+// systems such as tmpfs that refuse it.
+bool open_file(File & f, const std::string & path, int flags, bool direct) {
+  if (direct) {
+    f.fd = open(path.c_str(), flags | O_DIRECT, 0644);
+    if (f.fd >= 0) return true;
+    if (errno != EINVAL) return io_error("cannot open", path);
+    std::cerr << "Note: " << path << " does not support O_DIRECT, using buffered I/O\n";
+  }
+  f.fd = open(path.c_str(), flags, 0644);
+  return f.fd >= 0 || io_error("cannot open", path);
+}
+
+
+// pread until bytes are read or EOF. Returns the bytes read, or -1.
+ssize_t read_full(int fd, void * buf, size_t bytes, off_t offset) {
+  size_t done = 0;
+  while (done < bytes) {
+    ssize_t got = pread(fd, static_cast<char *>(buf) + done, bytes - done, offset + done);
+    if (got < 0 && errno == EINTR) continue;
+    if (got < 0) return -1;
+    if (got == 0) break;
+    done += got;
+  }
+  return done;
+}
+
+
+bool write_full(int fd, const void * buf, size_t bytes, off_t offset) {
+  size_t done = 0;
+  while (done < bytes) {
+    ssize_t put = pwrite(fd, static_cast<const char *>(buf) + done, bytes - done, offset + done);
+    if (put < 0 && errno == EINTR) continue;
+    if (put <= 0) return false;
+    done += put;
+  }
+  return true;
+}
+
+
+struct Run {
+  off_t offset;  // aligned start in the run file
+  size_t n;
+};
+
+
+// Double-buffered reader over one run: the merge consumes buf[active]
+// while the next block is read into the other buffer.
+struct RunReader {
+  int fd;
+  off_t next_offset;
+  size_t unread;
+  size_t block_elems;
+  AlignedBuffer buf[2];
+  int active = 1;
+  const int * pos = nullptr;
+  const int * end = nullptr;
+  std::future<ssize_t> pending;
+  size_t pending_n = 0;
+
+  void prefetch() {
+    if (unread == 0) return;
+
+    pending_n = std::min(block_elems, unread);
+    size_t bytes = round_up(pending_n * sizeof(int));
+    pending = std::async(std::launch::async, read_full, fd, buf[active ^ 1].data(), bytes, next_offset);
+    next_offset += bytes;
+    unread -= pending_n;
+  }
+
+  // Makes the prefetched block current. Returns false when the run is
+  // done; err is set if the read failed.
+  bool advance(bool & err) {
+    if (!pending.valid()) return false;
+
+    ssize_t got = pending.get();
+    if (got < static_cast<ssize_t>(pending_n * sizeof(int))) {
+      err = true;
+      return false;
+    }
+    active ^= 1;
+    pos = buf[active].data();
+    end = pos + pending_n;
+    prefetch();
+    return true;
+  }
+};
+
+
+// Phase 1: sorted runs of up to run_elems ints, spilled to tmp.
+bool form_runs(const File & in, size_t in_bytes, const File & tmp, const std::string & input,
+               const std::string & tmp_path, size_t run_elems, std::vector<Run> & runs) {
+  size_t run_bytes = run_elems * sizeof(int);
+  AlignedBuffer next(run_bytes), cur(run_bytes), scratch(run_bytes);
+  size_t chunks = (in_bytes + run_bytes - 1) / run_bytes;
+  off_t tmp_offset = 0;
+
+  std::future<ssize_t> reading;
+  if (chunks > 0) {
+    reading = std::async(std::launch::async, read_full, in.fd, next.data(), run_bytes, 0);
+  }
+
+  for (size_t c = 0; c < chunks; c++) {
+    size_t want = std::min(run_bytes, in_bytes - c * run_bytes);
+    ssize_t got = reading.get();
+    if (got < static_cast<ssize_t>(want)) return io_error("cannot read", input);
+
+    std::swap(next, cur);
+    if (c + 1 < chunks) {
+      reading = std::async(std::launch::async, read_full, in.fd, next.data(), run_bytes,
+                           static_cast<off_t>((c + 1) * run_bytes));
+    }
+
+    size_t n = want / sizeof(int);
+    radix_sort(cur.data(), n, scratch.data());
+
+    if (!write_full(tmp.fd, cur.data(), round_up(want), tmp_offset)) return io_error("cannot write", tmp_path);
+    runs.push_back({tmp_offset, n});
+    tmp_offset += round_up(want);
+  }
+  return true;
+}
+
+
+// Phase 2: one-pass k-way merge of runs into out.
+bool merge_runs(const File & tmp, const std::string & tmp_path, const std::vector<Run> & runs,
+                const File & out, const std::string & output, size_t memory_bytes, bool direct) {
+  int k = runs.size();
+
+  // Two blocks per run plus two for the output.
+  size_t block_bytes = std::min(EXT_MAX_BLOCK, round_down(memory_bytes / (2 * k + 2)));
+  if (block_bytes < EXT_IO_ALIGN) {
+    block_bytes = EXT_IO_ALIGN;
+    std::cerr << "Note: " << k << " runs need more than --mem for the merge buffers\n";
+  }
+  size_t block_elems = block_bytes / sizeof(int);
+
+  std::vector<RunReader> readers(k);
+  LoserTree tree(k);
+  bool err = false;
+
+  for (int r = 0; r < k; r++) {
+    RunReader & rr = readers[r];
+    rr.fd = tmp.fd;
+    rr.next_offset = runs[r].offset;
+    rr.unread = runs[r].n;
+    rr.block_elems = block_elems;
+    rr.buf[0] = AlignedBuffer(block_bytes);
+    rr.buf[1] = AlignedBuffer(block_bytes);
+    rr.prefetch();
+  }
+  for (int r = 0; r < k; r++) {
+    if (readers[r].advance(err)) {
+      tree.set(r, *readers[r].pos);
+    } else {
+      tree.set_exhausted(r);
+    }
+  }
+  if (err) return io_error("cannot read", tmp_path);
+  tree.build();
+
+  AlignedBuffer out_buf[2] = {AlignedBuffer(block_bytes), AlignedBuffer(block_bytes)};
+  int out_active = 0;
+  int * o = out_buf[0].data();
+  int * o_end = o + block_elems;
+  off_t out_offset = 0;
+  std::future<bool> writing;
+
+  // Hands the filled block to the writer thread and switches buffers.
+  auto flush = [&]() {
+    size_t bytes = (o - out_buf[out_active].data()) * sizeof(int);
+    if (writing.valid() && !writing.get()) return false;
+    writing = std::async(std::launch::async, write_full, out.fd, out_buf[out_active].data(),
+                         direct ? round_up(bytes) : bytes, out_offset);
+    out_offset += bytes;
+    out_active ^= 1;
+    o = out_buf[out_active].data();
+    o_end = o + block_elems;
+    return true;
+  };
+
+  while (!tree.empty()) {
+    int s = tree.winner();
+    *o++ = tree.winner_key();
+    if (o == o_end && !flush()) return io_error("cannot write", output);
+
+    RunReader & rr = readers[s];
+    if (++rr.pos != rr.end || rr.advance(err)) {
+      tree.set(s, *rr.pos);
+    } else {
+      if (err) return io_error("cannot read", tmp_path);
+      tree.set_exhausted(s);
+    }
+    tree.replay(s);
+  }
+
+  if (!flush() || !writing.get()) return io_error("cannot write", output);
+  // O_DIRECT wrote the last block padded; cut the file back to size.
+  if (ftruncate(out.fd, out_offset) != 0) return io_error("cannot truncate", output);
+  return true;
+}
+
+} // namespace
+
+
+bool external_sort(const std::string & input, const std::string & output,
+                   const ExternalSortOptions & options, ExternalSortStats & stats) {
+  File in, tmp, out;
+  std::string tmp_path = output + ".runs.tmp";
+
+  if (!open_file(in, input, O_RDONLY, options.direct_io)) return false;
+
+  struct stat st;
+  if (fstat(in.fd, &st) != 0) return io_error("cannot stat", input);
+  size_t in_bytes = st.st_size;
+  if (in_bytes % sizeof(int) != 0) {
+    std::cerr << "ERROR: " << input << " is not a whole number of ints\n";
+    return false;
+  }
+
+  if (!open_file(tmp, tmp_path, O_RDWR | O_CREAT | O_TRUNC, options.direct_io)) return false;
+  tmp.unlink_path = tmp_path;
+  if (!open_file(out, output, O_WRONLY | O_CREAT | O_TRUNC, options.direct_io)) return false;
+
+  // Phase 1 holds three runs: one being read, one being sorted, scratch.
+  size_t run_bytes = std::max(EXT_IO_ALIGN, round_down(options.memory_bytes / 3));
+  std::vector<Run> runs;
+
+  auto start = std::chrono::steady_clock::now();
+  if (!form_runs(in, in_bytes, tmp, input, tmp_path, run_bytes / sizeof(int), runs)) return false;
+  auto mid = std::chrono::steady_clock::now();
+  if (!merge_runs(tmp, tmp_path, runs, out, output, options.memory_bytes, options.direct_io)) return false;
+  auto stop = std::chrono::steady_clock::now();
+
+  stats.elements = in_bytes / sizeof(int);
+  stats.runs = runs.size();
+  stats.run_ms = std::chrono::duration<double, std::milli>(mid - start).count();
+  stats.merge_ms = std::chrono::duration<double, std::milli>(stop - mid).count();
+  return true;
+}
+
+
+bool parse_memory_size(const std::string & s, size_t & bytes) {
+  size_t used = 0;
+  double value;
+  try {
+    value = std::stod(s, &used);
+  } catch (const std::exception &) {
+    return false;
+  }
+
+  std::string suffix = s.substr(used);
+  if (!suffix.empty() && (suffix.back() == 'B' || suffix.back() == 'b')) suffix.pop_back();
+
+  double scale = 1;
+  if (suffix == "K" || suffix == "k") scale = 1 << 10;
+  else if (suffix == "M" || suffix == "m") scale = 1 << 20;
+  else if (suffix == "G" || suffix == "g") scale = 1 << 30;
+  else if (!suffix.empty()) return false;
+
+  if (value <= 0) return false;
+  bytes = static_cast<size_t>(value * scale);
+  return true;
+}
@@ -0,0 +1,46 @@
+#ifndef EXTERNAL_SORT_H
+#define EXTERNAL_SORT_H
+
+#include <string>
+#include <cstddef>
+
+
+/* External merge sort of a raw file of native-endian ints, for inputs
+   bigger than RAM.
+
+   Phase 1 reads the input one memory-sized chunk at a time, radix sorts
+   it and spills it as a run to a temporary file next to the output. The
+   next chunk is read on a second thread while the current one is sorted
+   and written.
+
+   Phase 2 merges all runs in one pass through a loser tree. Each run gets
+   two input blocks and the output gets two: one is consumed or filled
+   while the other is being read or written in the background.
+
+   All I/O is large sequential pread/pwrite. With direct_io the files are
+   opened O_DIRECT and every buffer, offset and length is kept aligned to
+   EXT_IO_ALIGN; where the file system refuses O_DIRECT it falls back to
+   buffered I/O. */
+
+const size_t EXT_IO_ALIGN = 4096;
+
+struct ExternalSortOptions {
+  size_t memory_bytes = size_t(1) << 30;  // budget for all buffers
+  bool direct_io = false;
+};
+
+struct ExternalSortStats {
+  size_t elements = 0;
+  size_t runs = 0;
+  double run_ms = 0;    // phase 1: read, sort, spill
+  double merge_ms = 0;  // phase 2: k-way merge
+};
+
+// Returns false and prints the reason on I/O errors.
+bool external_sort(const std::string & input, const std::string & output,
+                   const ExternalSortOptions & options, ExternalSortStats & stats);
+
+// Parses a byte count with an optional K, M or G suffix, e.g. 4G.
+bool parse_memory_size(const std::string & s, size_t & bytes);
+
+#endif // EXTERNAL_SORT_H
@@ -0,0 +1,320 @@
+#ifndef FREQUENCY_H
+#define FREQUENCY_H
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+
+#include "thread_pool.h"
+#include "reduce_kernels.h"
+
+
+/* Key frequencies in one pass over the input, for mode.cpp.
+   After one min/max pass, a counter is picked:
+   - Dense histogram, one uint32 per key in [min, max], when the range is
+     at most max(n / threads, FREQ_DENSE_MIN_RANGE). Each key is one
+     increment with no hashing or probing.
+   - Hash counting otherwise. With millions of distinct keys, one big
+     table misses cache on nearly every key (1 s for 10^7 keys here). So
+     the keys are first scattered into up to 2^FREQ_MAX_PARTITION_BITS
+     partitions by bits of their hash, as sample_sort scatters to buckets.
+     Each partition is then counted in a HashCounter small enough to stay
+     in cache: open addressing, linear probing, at most half full.
+   Dense: each thread counts its own stripe into its own histogram, and the
+   histograms are summed, one slice of the range per thread. The bound on
+   the range keeps all of them together no larger than the input. Hash:
+   partitions hold disjoint keys, so each thread counts whole partitions
+   and only the per-thread answers are merged. Either way, one scan of the
+   counts gives the mode, the distinct count and the top k. Counts are
+   32-bit, so n must be below 2^32. */
+
+const int64_t FREQ_DENSE_MIN_RANGE = 1 << 16;  // key ranges always counted densely
+const size_t FREQ_PARALLEL_MIN = 1 << 16;      // fewer keys: one thread
+const int FREQ_MAX_PARTITION_BITS = 10;
+const size_t FREQ_PARTITION_KEYS = 1 << 13;    // keys per partition aimed for
+const size_t HASH_COUNTER_MIN = 1024;          // starting slots
+const uint64_t FIBONACCI_HASH = 0x9E3779B97F4A7C15ull;
+
+
+// Partition of key out of parts (a power of two): bits 32 and up of the
+// hash, clear of the top bits that HashCounter probes with.
+inline size_t frequency_partition(int key, size_t parts) {
+  return ((static_cast<uint32_t>(key) * FIBONACCI_HASH) >> 32) & (parts - 1);
+}
+
+
+class HashCounter {
+public:
+  explicit HashCounter(size_t expected = 0) {
+    size_t slots = HASH_COUNTER_MIN;
+    while (slots < 2 * expected) slots *= 2;
+    resize(slots);
+    used_.reserve(expected);
+  }
+
+  void add(int key, uint32_t count = 1) {
+    size_t i = home(key);
+    while (slots_[i].count != 0 && slots_[i].key != key) {
+      i = (i + 1) & mask_;
+    }
+    if (slots_[i].count == 0) {
+      slots_[i].key = key;
+      used_.push_back(static_cast<uint32_t>(i));
+      if (used_.size() * 2 > slots_.size()) {
+        slots_[i].count = count;
+        grow();
+        return;
+      }
+    }
+    slots_[i].count += count;
+  }
+
+  // Distinct keys.
+  size_t size() const { return used_.size(); }
+
+  // Calls f(key, count) for every key, in the order they first came. Going
+  // through used_ skips the empty slots without a branch on each one.
+  template <typename F>
+  void for_each(F f) const {
+    for (uint32_t i : used_) {
+      f(slots_[i].key, slots_[i].count);
+    }
+  }
+
+private:
+  struct Slot {
+    int key;
+    uint32_t count;  // 0: empty
+  };
+
+  std::vector<Slot> slots_;
+  std::vector<uint32_t> used_;  // slots in use, in insertion order
+  size_t mask_ = 0;
+  int shift_ = 0;
+
+  // Fibonacci hashing: the top bits of key * 2^64 / phi.
+  size_t home(int key) const {
+    return (static_cast<uint32_t>(key) * FIBONACCI_HASH) >> shift_;
+  }
+
+  void resize(size_t slots) {
+    slots_.assign(slots, Slot{0, 0});
+    mask_ = slots - 1;
+    shift_ = 64 - __builtin_ctzll(slots);
+  }
+
+  void grow() {
+    std::vector<Slot> old;
+    std::vector<uint32_t> order;
+    old.swap(slots_);
+    order.swap(used_);
+    resize(old.size() * 2);
+    for (uint32_t i : order) {
+      add(old[i].key, old[i].count);
+    }
+  }
+};
+
+
+struct Frequencies {
+  int mode = 0;              // most frequent key, the smallest on ties; 0 when empty
+  uint32_t mode_count = 0;
+  size_t distinct = 0;
+  std::vector<std::pair<int, uint32_t>> top;  // (key, count), most frequent first, ties by key
+  bool dense = false;        // which counter was used
+};
+
+
+// Collects the answers while every (key, count) goes by once. The top k
+// sit in a min-heap of packed words, count in the high half and the key
+// inverted in the low, so a higher count wins and, on equal counts, the
+// smaller key.
+class FrequencyScan {
+public:
+  explicit FrequencyScan(int k) : k_(std::max(k, 0)) { heap_.reserve(k_); }
+
+  void add(int key, uint32_t count) {
+    distinct_++;
+    add_rank(static_cast<uint64_t>(count) << 32 | ~(static_cast<uint32_t>(key) ^ 0x80000000u));
+  }
+
+  // Takes in the keys other has seen, which must be none of this one's.
+  void merge(const FrequencyScan & other) {
+    distinct_ += other.distinct_;
+    if (other.best_ > best_) best_ = other.best_;
+    for (uint64_t rank : other.heap_) {
+      add_rank(rank);
+    }
+  }
+
+  Frequencies result(bool dense) const {
+    Frequencies f;
+    f.dense = dense;
+    f.distinct = distinct_;
+    if (distinct_ > 0) {
+      f.mode = unpack_key(best_);
+      f.mode_count = static_cast<uint32_t>(best_ >> 32);
+    }
+
+    std::vector<uint64_t> ranks = heap_;
+    std::sort(ranks.begin(), ranks.end(), std::greater<uint64_t>());
+    for (uint64_t r : ranks) {
+      f.top.emplace_back(unpack_key(r), static_cast<uint32_t>(r >> 32));
+    }
+    return f;
+  }
+
+private:
+  int k_;
+  std::vector<uint64_t> heap_;
+  uint64_t best_ = 0;
+  size_t distinct_ = 0;
+
+  void add_rank(uint64_t rank) {
+    if (rank > best_) best_ = rank;
+
+    if (static_cast<int>(heap_.size()) < k_) {
+      heap_.push_back(rank);
+      std::push_heap(heap_.begin(), heap_.end(), std::greater<uint64_t>());
+    } else if (k_ > 0 && rank > heap_.front()) {
+      std::pop_heap(heap_.begin(), heap_.end(), std::greater<uint64_t>());
+      heap_.back() = rank;
+      std::push_heap(heap_.begin(), heap_.end(), std::greater<uint64_t>());
+    }
+  }
+
+  static int unpack_key(uint64_t rank) {
+    return static_cast<int>(~static_cast<uint32_t>(rank) ^ 0x80000000u);
+  }
+};
+
+
+// Mode, distinct count and the k most frequent keys of a, counted on
+// threads threads.
+inline Frequencies frequencies(const std::vector<int> & a, int k = 0, int threads = 1) {
+  size_t n = a.size();
+  if (n == 0) return FrequencyScan(k).result(true);
+
+  if (threads < 1) threads = 1;
+  if (n < FREQ_PARALLEL_MIN) threads = 1;
+  size_t stripe = (n + threads - 1) / threads;
+
+  MinMax bounds = min_max(a, threads);
+  int lo = bounds.min;
+  int64_t range = static_cast<int64_t>(bounds.max) - lo + 1;
+  bool dense = range <= std::max<int64_t>(n / threads, FREQ_DENSE_MIN_RANGE);
+
+  ThreadPool pool(threads);
+
+  if (dense) {
+    std::vector<std::vector<uint32_t>> hist(threads);
+    {
+      TaskGroup group(pool);
+      for (int t = 0; t < threads; t++) {
+        group.run([&, t] {
+          hist[t].assign(range, 0);
+          uint32_t * h = hist[t].data();
+          size_t end = std::min(n, (t + 1) * stripe);
+          for (size_t i = t * stripe; i < end; i++) {
+            h[static_cast<int64_t>(a[i]) - lo]++;
+          }
+        });
+      }
+    }
+
+    // Each thread sums one slice of the key range into hist[0].
+    if (threads > 1) {
+      TaskGroup group(pool);
+      for (int t = 0; t < threads; t++) {
+        group.run([&, t] {
+          size_t begin = range * t / threads, end = range * (t + 1) / threads;
+          for (int u = 1; u < threads; u++) {
+            for (size_t x = begin; x < end; x++) {
+              hist[0][x] += hist[u][x];
+            }
+          }
+        });
+      }
+    }
+
+    FrequencyScan scan(k);
+    const uint32_t * h = hist[0].data();
+    for (int64_t x = 0; x < range; x++) {
+      if (h[x] != 0) scan.add(static_cast<int>(lo + x), h[x]);
+    }
+    return scan.result(true);
+  }
+
+  // Partition the keys by hash, then count one partition at a time.
+  int bits = 0;
+  while (bits < FREQ_MAX_PARTITION_BITS && (n >> bits) > FREQ_PARTITION_KEYS) bits++;
+  size_t parts = static_cast<size_t>(1) << bits;
+
+  std::vector<size_t> counts(threads * parts, 0);
+  {
+    TaskGroup group(pool);
+    for (int t = 0; t < threads; t++) {
+      group.run([&, t] {
+        size_t * count = &counts[t * parts];
+        size_t end = std::min(n, (t + 1) * stripe);
+        for (size_t i = t * stripe; i < end; i++) {
+          count[frequency_partition(a[i], parts)]++;
+        }
+      });
+    }
+  }
+
+  // Exclusive prefix sums, partition-major, as in sample_sort.
+  std::vector<size_t> part_start(parts + 1);
+  size_t sum = 0;
+  for (size_t p = 0; p < parts; p++) {
+    part_start[p] = sum;
+    for (int t = 0; t < threads; t++) {
+      size_t c = counts[t * parts + p];
+      counts[t * parts + p] = sum;
+      sum += c;
+    }
+  }
+  part_start[parts] = n;
+
+  std::vector<int> scratch(n);
+  {
+    TaskGroup group(pool);
+    for (int t = 0; t < threads; t++) {
+      group.run([&, t] {
+        size_t * offset = &counts[t * parts];
+        size_t end = std::min(n, (t + 1) * stripe);
+        for (size_t i = t * stripe; i < end; i++) {
+          scratch[offset[frequency_partition(a[i], parts)]++] = a[i];
+        }
+      });
+    }
+  }
+
+  // A partition holds all of its keys, so each thread counts a share of
+  // the partitions into its own scan, and only the scans are merged.
+  std::vector<FrequencyScan> scans(threads, FrequencyScan(k));
+  {
+    TaskGroup group(pool);
+    for (int t = 0; t < threads; t++) {
+      group.run([&, t] {
+        for (size_t p = parts * t / threads; p < parts * (t + 1) / threads; p++) {
+          HashCounter counter(part_start[p + 1] - part_start[p]);
+          for (size_t i = part_start[p]; i < part_start[p + 1]; i++) {
+            counter.add(scratch[i]);
+          }
+          counter.for_each([&](int key, uint32_t count) { scans[t].add(key, count); });
+        }
+      });
+    }
+  }
+
+  for (int t = 1; t < threads; t++) {
+    scans[0].merge(scans[t]);
+  }
+  return scans[0].result(false);
+}
+
+#endif // FREQUENCY_H
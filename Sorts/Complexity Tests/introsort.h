@@ -0,0 +1,146 @@
+#ifndef INTROSORT_H
+#define INTROSORT_H
+
+#include <vector>
+#include <utility>
+
+#include "sort_kernels.h"
+
+
+// Introsort: quicksort with a median-of-three (ninther for large ranges)
+// pivot, a sorting network for small partitions and a heapsort fallback once
+// the recursion passes 2*log2(n). Only the smaller side is recursed on, the
+// larger one is looped on, so the stack stays O(log n) even on sorted input.
+
+const int INTRO_SMALL_CUTOFF = 32;      // sort_kernels.h network size
+const int INTRO_NINTHER_CUTOFF = 128;
+
+
+// Max-heap stored in arr[l..l+n-1], root is the heap index to sift down.
+inline void sift_down(std::vector<int> & arr, int l, int root, int n) {
+  int x = arr[l + root];
+
+  while (2 * root + 1 < n) {
+    int child = 2 * root + 1;
+    if (child + 1 < n && arr[l + child] < arr[l + child + 1]) {
+      child++;
+    }
+    if (arr[l + child] <= x) break;
+
+    arr[l + root] = arr[l + child];
+    root = child;
+  }
+  arr[l + root] = x;
+}
+
+
+inline void heapsort(std::vector<int> & arr, int l, int h) {
+  int n = h - l + 1;
+
+  for (int i = n / 2 - 1; i >= 0; i--) {
+    sift_down(arr, l, i, n);
+  }
+  for (int end = n - 1; end > 0; end--) {
+    std::swap(arr[l], arr[l + end]);
+    sift_down(arr, l, 0, end);
+  }
+}
+
+
+// Orders arr[a] <= arr[b] <= arr[c].
+inline void sort3(std::vector<int> & arr, int a, int b, int c) {
+  if (arr[b] < arr[a]) std::swap(arr[a], arr[b]);
+  if (arr[c] < arr[b]) std::swap(arr[b], arr[c]);
+  if (arr[b] < arr[a]) std::swap(arr[a], arr[b]);
+}
+
+
+// Moves the median of three (or Tukey's ninther) into arr[l].
+inline void choose_pivot(std::vector<int> & arr, int l, int h) {
+  int m = l + (h - l) / 2;
+
+  if (h - l + 1 > INTRO_NINTHER_CUTOFF) {
+    int s = (h - l + 1) / 8;
+    sort3(arr, l, l + s, l + 2 * s);
+    sort3(arr, m - s, m, m + s);
+    sort3(arr, h - 2 * s, h - s, h);
+    sort3(arr, l + s, m, h - s);
+  } else {
+    sort3(arr, l, m, h);
+  }
+  std::swap(arr[l], arr[m]);
+}
+
+
+/* Hoare-style partition around the pivot already in arr[l]. Both scans
+   stop on keys equal to the pivot, so runs of duplicates are split evenly
+   instead of all landing on one side. Returns the pivot's final position. */
+
+inline int pivot_partition(std::vector<int> & arr, int l, int h) {
+  int x = arr[l];
+  int i = l, j = h + 1;
+
+  while (true) {
+    while (arr[++i] < x) {
+      if (i == h) break;
+    }
+    while (x < arr[--j]) {
+      // arr[l] == x stops this scan.
+    }
+    if (i >= j) break;
+    std::swap(arr[i], arr[j]);
+  }
+  std::swap(arr[l], arr[j]);
+  return j;
+}
+
+
+inline int intro_partition(std::vector<int> & arr, int l, int h) {
+  choose_pivot(arr, l, h);
+  return pivot_partition(arr, l, h);
+}
+
+
+// Partition scheme: takes arr[l..h], returns the pivot's final position.
+typedef int (*partition_fn)(std::vector<int> & arr, int l, int h);
+
+
+inline void introsort_loop(std::vector<int> & arr, int l, int h, int depth,
+                           partition_fn partition = intro_partition) {
+  while (h - l + 1 > INTRO_SMALL_CUTOFF) {
+    if (depth == 0) {
+      heapsort(arr, l, h);
+      return;
+    }
+    depth--;
+
+    int p = partition(arr, l, h);
+    if (p - l < h - p) {
+      introsort_loop(arr, l, p - 1, depth, partition);
+      l = p + 1;
+    } else {
+      introsort_loop(arr, p + 1, h, depth, partition);
+      h = p - 1;
+    }
+  }
+  if (h > l) small_sort(&arr[l], h - l + 1);
+}
+
+
+// Sorts arr[l..h] with a depth limit of 2*log2(h - l + 1).
+inline void introsort_range(std::vector<int> & arr, int l, int h,
+                            partition_fn partition = intro_partition) {
+  int depth = 0;
+  for (int k = h - l + 1; k > 1; k >>= 1) {
+    depth += 2;
+  }
+  introsort_loop(arr, l, h, depth, partition);
+}
+
+
+inline void introsort(std::vector<int> & arr) {
+  if (arr.size() < 2) return;
+  introsort_range(arr, 0, arr.size() - 1);
+}
+
+#endif // INTROSORT_H
@@ -0,0 +1,110 @@
+#ifndef KWAY_MERGE_H
+#define KWAY_MERGE_H
+
+#include <vector>
+#include <span>
+#include <cstddef>
+
+#include "loser_tree.h"
+
+
+/* In-memory k-way merge of sorted int runs through a loser tree
+   (loser_tree.h). The tree keeps one packed 64-bit rank per run, so with
+   hundreds of runs it still fits in a few KB of cache, and each output
+   costs one compare per level on a single leaf-to-root path. A run that
+   runs dry becomes the +inf sentinel, so the inner loop never checks for
+   empty runs. Ties go to the lower run index, which keeps the merge
+   stable.
+
+   KWayMerge streams: read() hands out the next block of merged output, so
+   a consumer can start on the smallest keys before the rest is merged.
+   kway_merge() merges everything into one vector or feeds a sink block by
+   block. */
+
+const size_t KWAY_BLOCK = 4096;  // elements per block for the sink form
+
+
+class KWayMerge {
+public:
+  explicit KWayMerge(const std::vector<std::span<const int>> & runs) : tree_(runs.size()) {
+    for (size_t r = 0; r < runs.size(); r++) {
+      cursors_.push_back({runs[r].data(), runs[r].data() + runs[r].size()});
+      if (runs[r].empty()) {
+        tree_.set_exhausted(r);
+      } else {
+        tree_.set(r, runs[r].front());
+        remaining_ += runs[r].size();
+      }
+    }
+    tree_.build();
+  }
+
+  explicit KWayMerge(const std::vector<std::vector<int>> & runs) : KWayMerge(spans(runs)) {}
+
+  bool done() const { return tree_.empty(); }
+
+  // Elements not handed out yet.
+  size_t remaining() const { return remaining_; }
+
+  // Writes the next min(max, remaining()) merged elements to out and
+  // returns how many.
+  size_t read(int * out, size_t max) {
+    size_t n = 0;
+    while (n < max && !tree_.empty()) {
+      int s = tree_.winner();
+      out[n++] = tree_.winner_key();
+
+      Cursor & c = cursors_[s];
+      if (++c.pos != c.end) {
+        tree_.set(s, *c.pos);
+      } else {
+        tree_.set_exhausted(s);
+      }
+      tree_.replay(s);
+    }
+    remaining_ -= n;
+    return n;
+  }
+
+private:
+  // Next element and end of each run, side by side in one array.
+  struct Cursor {
+    const int * pos;
+    const int * end;
+  };
+
+  std::vector<Cursor> cursors_;
+  LoserTree tree_;
+  size_t remaining_ = 0;
+
+  static std::vector<std::span<const int>> spans(const std::vector<std::vector<int>> & runs) {
+    std::vector<std::span<const int>> s;
+    for (const std::vector<int> & r : runs) {
+      s.emplace_back(r);
+    }
+    return s;
+  }
+};
+
+
+// Merges every run into out, resized to fit.
+inline void kway_merge(const std::vector<std::vector<int>> & runs, std::vector<int> & out) {
+  KWayMerge merge(runs);
+  out.resize(merge.remaining());
+  merge.read(out.data(), out.size());
+}
+
+
+// Calls sink(const int * block, size_t n) with the merged output, KWAY_BLOCK
+// elements at a time, without materializing the whole result.
+template <typename Sink>
+void kway_merge(const std::vector<std::vector<int>> & runs, Sink sink) {
+  KWayMerge merge(runs);
+  std::vector<int> block(KWAY_BLOCK);
+
+  while (size_t n = merge.read(block.data(), block.size())) {
+    sink(static_cast<const int *>(block.data()), n);
+  }
+}
+
+#endif // KWAY_MERGE_H
@@ -0,0 +1,88 @@
+#ifndef LOSER_TREE_H
+#define LOSER_TREE_H
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include "radix_sort.h"
+
+
+/* Tournament tree of losers for k-way merging of int runs.
+   Each of the k sources holds its current head key. Internal node i keeps
+   the loser of the match played there, and node 0 the overall winner, so
+   replacing the winner's key costs one match per level (log2 k) on the
+   path from its leaf to the root.
+
+   A player is packed into one 64-bit rank, the order-preserving key
+   (radix_key) above the source index, so a match is a single unsigned
+   compare that compiles to a conditional move. Equal keys go to the lower
+   source, which keeps the merge stable. An exhausted source is the
+   all-ones rank, a +inf sentinel that loses every match; the merge is done
+   when the winner is exhausted.
+
+   Use:
+     for each source s: tree.set(s, head) or tree.set_exhausted(s)
+     tree.build()
+     while (!tree.empty()) {
+       int s = tree.winner();
+       ... emit tree.winner_key(), advance s ...
+       tree.set(s, next) or tree.set_exhausted(s)
+       tree.replay(s)
+     } */
+
+class LoserTree {
+public:
+  explicit LoserTree(int k) : k_(k), leaves_(k, EXHAUSTED), tree_(std::max(k, 1), EXHAUSTED) {}
+
+  int size() const { return k_; }
+
+  void set(int source, int key) {
+    leaves_[source] = static_cast<uint64_t>(radix_key(key)) << 32 | static_cast<uint32_t>(source);
+  }
+
+  void set_exhausted(int source) { leaves_[source] = EXHAUSTED; }
+
+  int winner() const { return static_cast<uint32_t>(tree_[0]); }
+
+  int winner_key() const { return static_cast<int>(static_cast<uint32_t>(tree_[0] >> 32) ^ 0x80000000u); }
+
+  bool empty() const { return tree_[0] == EXHAUSTED; }
+
+  // Plays every match from scratch, O(k).
+  void build() {
+    if (k_ > 0) tree_[0] = k_ == 1 ? leaves_[0] : build(1);
+  }
+
+  // Replays the matches on source's path after its key changed.
+  void replay(int source) {
+    uint64_t w = leaves_[source];
+    for (int node = (source + k_) / 2; node > 0; node /= 2) {
+      uint64_t other = tree_[node];
+      bool lost = other < w;
+      tree_[node] = lost ? w : other;
+      w = lost ? other : w;
+    }
+    tree_[0] = w;
+  }
+
+private:
+  static const uint64_t EXHAUSTED = ~static_cast<uint64_t>(0);
+
+  int k_;
+  std::vector<uint64_t> leaves_;
+  std::vector<uint64_t> tree_;
+
+  // Leaves sit at positions k..2k-1 of an implicit heap; node i's children
+  // are 2i and 2i + 1. Returns the winner below node.
+  uint64_t build(int node) {
+    if (node >= k_) return leaves_[node - k_];
+
+    uint64_t a = build(2 * node);
+    uint64_t b = build(2 * node + 1);
+    tree_[node] = std::max(a, b);
+    return std::min(a, b);
+  }
+};
+
+#endif // LOSER_TREE_H
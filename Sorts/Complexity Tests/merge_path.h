@@ -0,0 +1,98 @@
+#ifndef MERGE_PATH_H
+#define MERGE_PATH_H
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+#include "sort_kernels.h"
+#include "thread_pool.h"
+
+
+/* Merge path parallel merge (Odeh et al.).
+   Merging a and b walks a monotone path through the na x nb grid, one step
+   per output element. Output position d lies on the cross diagonal
+   i + j = d, and where the path crosses it can be found by a binary search
+   along that diagonal. Cutting the output into equal segments this way
+   gives every task exactly the same amount of work, whatever the keys look
+   like. A split at the midpoint of the larger input, by contrast, can
+   leave one half with almost everything. Each task finds its own two
+   splits, so the partitioning is parallel too, and then merges its segment
+   straight into the preallocated output.
+
+   Ties go to a, within and across segments, so the merge is stable. */
+
+const size_t MERGE_PATH_GRAIN = 16384;  // fewest outputs worth a segment
+
+
+// How many of the first d outputs of the merge come from a.
+inline size_t merge_path_split(const int * a, size_t na, const int * b, size_t nb, size_t d) {
+  size_t lo = d > nb ? d - nb : 0;
+  size_t hi = std::min(d, na);
+
+  // Smallest i with b[d - i - 1] < a[i]: a[i] is past the diagonal.
+  while (lo < hi) {
+    size_t i = lo + (hi - lo) / 2;
+    if (a[i] <= b[d - i - 1]) {
+      lo = i + 1;
+    } else {
+      hi = i;
+    }
+  }
+  return lo;
+}
+
+
+// Writes outputs [d0, d1) of the merge to out + d0. simd picks the register
+// merge (merge_sorted) over the scalar one.
+inline void merge_path_segment(const int * a, size_t na, const int * b, size_t nb, int * out,
+                               size_t d0, size_t d1, bool simd) {
+  size_t i0 = merge_path_split(a, na, b, nb, d0);
+  size_t i1 = merge_path_split(a, na, b, nb, d1);
+  size_t j0 = d0 - i0, j1 = d1 - i1;
+
+  if (simd) {
+    merge_sorted(a + i0, i1 - i0, b + j0, j1 - j0, out + d0);
+  } else {
+    merge_scalar(a + i0, i1 - i0, b + j0, j1 - j0, out + d0);
+  }
+}
+
+
+// Merges sorted a[0..na) and b[0..nb) into out[0..na + nb), cut into
+// equal-sized segments that run as tasks on pool.
+inline void parallel_merge(const int * a, size_t na, const int * b, size_t nb, int * out,
+                           ThreadPool & pool, size_t segments, bool simd = true) {
+  size_t n = na + nb;
+  if (segments < 1) segments = 1;
+  if (segments > n) segments = std::max<size_t>(n, 1);
+
+  TaskGroup group(pool);
+  for (size_t s = 1; s < segments; s++) {
+    group.run([=] { merge_path_segment(a, na, b, nb, out, n * s / segments, n * (s + 1) / segments, simd); });
+  }
+  merge_path_segment(a, na, b, nb, out, 0, n / segments, simd);
+  group.wait();
+}
+
+
+// Library entry point: merges a and b into out, resized to fit, with one
+// segment per thread unless that would make segments smaller than
+// MERGE_PATH_GRAIN.
+inline void parallel_merge(const std::vector<int> & a, const std::vector<int> & b,
+                           std::vector<int> & out, int threads, bool simd = true) {
+  size_t n = a.size() + b.size();
+  out.resize(n);
+  if (threads < 1) threads = 1;
+
+  size_t segments = std::min<size_t>(threads, std::max<size_t>(1, n / MERGE_PATH_GRAIN));
+  if (segments == 1) {
+    merge_path_segment(a.data(), a.size(), b.data(), b.size(), out.data(), 0, n, simd);
+    return;
+  }
+
+  ThreadPool pool(segments);
+  parallel_merge(a.data(), a.size(), b.data(), b.size(), out.data(), pool, segments, simd);
+}
+
+#endif // MERGE_PATH_H
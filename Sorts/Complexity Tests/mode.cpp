@@ -1,7 +1,17 @@
 #include <iostream>
 #include <vector>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <getopt.h>
 #include <sys/time.h>
 
+#include "datagen.h"
+#include "frequency.h"
+#include "sketches.h"
+#include "reduce_kernels.h"
+
 
 void print_vector(std::vector<int> vec) {
   for (auto it : vec) {
@@ -10,54 +20,242 @@ void print_vector(std::vector<int> vec) {
   std::cout << "\n";
 }
 
-int count(std::vector<int> vec, int x) {
-  int cnt = 0;
+// Both run on the vector kernels of reduce_kernels.h, without copying vec.
+size_t count(const std::vector<int> & vec, int x, int threads = 1) {
+  return count_equal(vec, x, threads);
+}
+
 
-  for (int i = 0; i < vec.size(); i++) {
-    if (vec[i] == x) {
-      cnt++;
-    }
+// INT_MIN for an empty vec. It used to start from 0, so it returned 0 for
+// all-negative keys.
+int largest(const std::vector<int> & vec, int threads = 1) {
+  return min_max(vec, threads).max;
+}
+
+
+// Most frequent key, the smallest of them on ties. One counting pass
+// (frequency.h) instead of a count() per element.
+int mode(const std::vector<int> & vec, int threads = 1) {
+  return frequencies(vec, 0, threads).mode;
+}
+
+
+std::vector<int> makeVec(int n, int max) {
+  std::vector<int> vec(n);
+
+  for (int i = 0; i < n; i++) {
+    vec.at(i) = rand() % max;
   }
-  return cnt;
+  return vec;
 }
 
 
-int largest(std::vector<int> vec) {
-  int max = 0;
+void print_help(char * command_name) {
+  std::cout << "Usage: " << command_name << " [-h|-s N|-m N|-t N|-k K|-r N|-d distribution|-S|-R]\n\n";
+  std::cout << " With no -s, the small demo on 10 keys.\n";
+  std::cout << " -s DATA_SET_SIZE  count the frequencies of a generated data set\n";
+  std::cout << " -m MAX_ELEMENT_SIZE (default: 1000000000)\n";
+  std::cout << " -t THREADS (default: all cores)\n";
+  std::cout << " -k K              also list the K most frequent keys (default: 10)\n";
+  std::cout << " -r SEED (default: 42)\n";
+  std::cout << " -d uniform|sorted|reverse|nearly|fewunique|organpipe|zipf|sawtooth\n";
+  std::cout << " -S                also stream the data set through the sketches (Misra-Gries,\n";
+  std::cout << "                   count-min, HyperLogLog) and compare them with the exact counts\n";
+  std::cout << " -R                time the reduction kernels (count, min/max, sum, argmax) on the\n";
+  std::cout << "                   data set against plain loops, instead of counting frequencies\n";
+}
 
-  for (int i = 0; i < vec.size(); i++) {
-    if (vec[i] > max) {
-      max = vec[i];
-    }
+
+double ms_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+// -S: the sketches of sketches.h, fed vec in blocks on threads threads,
+// against the exact answers in f.
+void run_sketches(const std::vector<int> & vec, const Frequencies & f, int threads, int k) {
+  const size_t CAPACITY = 1024;
+  const double EPSILON = 1e-4, DELTA = 0.01;
+  const int PRECISION = 14;
+
+  MisraGries mg(CAPACITY);
+  auto start = std::chrono::steady_clock::now();
+  parallel_update(mg, vec.data(), vec.size(), threads);
+  std::cout << "\nMisra-Gries, " << CAPACITY << " counters (" << mg.bytes() / 1024 << " KB): "
+            << ms_since(start) << " ms\n";
+  for (const MisraGries::Item & it : mg.top(k)) {
+    std::cout << " " << it.key << " (" << it.count - it.error << ".." << it.count << ", exact "
+              << std::count(vec.begin(), vec.end(), it.key) << ")";
+  }
+  std::cout << "\n";
+
+  CountMinSketch cm = CountMinSketch::with_error(EPSILON, DELTA);
+  start = std::chrono::steady_clock::now();
+  parallel_update(cm, vec.data(), vec.size(), threads);
+  double cm_ms = ms_since(start);
+  uint64_t worst = 0;
+  for (auto & kc : f.top) {
+    worst = std::max(worst, cm.estimate(kc.first) - kc.second);
   }
-  return max;
+  std::cout << "Count-min, epsilon " << EPSILON << ", delta " << DELTA << " (" << cm.bytes() / 1024 << " KB): "
+            << cm_ms << " ms\n Mode " << f.mode << ": " << cm.estimate(f.mode) << " (exact " << f.mode_count
+            << "), worst overcount in the top " << f.top.size() << ": " << worst
+            << " (bound " << static_cast<uint64_t>(EPSILON * vec.size()) << ")\n";
+
+  HyperLogLog hll(PRECISION);
+  start = std::chrono::steady_clock::now();
+  parallel_update(hll, vec.data(), vec.size(), threads);
+  double hll_ms = ms_since(start);
+  double error = (hll.estimate() - static_cast<double>(f.distinct)) / f.distinct * 100;
+  std::cout << "HyperLogLog, 2^" << PRECISION << " registers (" << hll.bytes() / 1024 << " KB): " << hll_ms
+            << " ms\n Distinct: " << static_cast<long long>(hll.estimate()) << " (exact " << f.distinct << ", "
+            << error << "%)\n";
 }
 
 
-int mode(std::vector<int> vec) {
-  int mode = 0, freqs = 0;
+// -R: each reduction as a plain loop, then through reduce_kernels.h on one
+// thread and on threads threads. Best of REPS, as ms and GB/s read.
+void run_reductions(const std::vector<int> & vec, int threads) {
+  const int REPS = 5;
+  int x = vec.empty() ? 0 : vec[vec.size() / 2];
+  double gb = vec.size() * sizeof(int) / 1e9;
+  long long check = 0;  // keeps every result live
 
-  for (int i = 0; i < vec.size(); i++) {
-    if (count(vec, vec[i]) > freqs) {
-      freqs = count(vec, vec[i]);
-      mode = vec[i];
+  auto time = [&](const char * name, auto reduce) {
+    double best = 1e300;
+    for (int r = 0; r < REPS; r++) {
+      auto start = std::chrono::steady_clock::now();
+      check += static_cast<long long>(reduce());
+      best = std::min(best, ms_since(start));
     }
-  }
-  return mode;
+    std::cout << " " << name << ": " << best << " ms, " << gb / best * 1000 << " GB/s\n";
+  };
+
+  std::cout << "count of " << x << ":\n";
+  time("loop", [&] {
+    size_t c = 0;
+    for (int v : vec) c += v == x;
+    return c;
+  });
+  time("count_equal", [&] { return count_equal(vec, x); });
+  time("count_equal, threads", [&] { return count_equal(vec, x, threads); });
+
+  std::cout << "min and max:\n";
+  time("loop", [&] {
+    int lo = INT_MAX, hi = INT_MIN;
+    for (int v : vec) {
+      lo = std::min(lo, v);
+      hi = std::max(hi, v);
+    }
+    return static_cast<long long>(lo) + hi;
+  });
+  time("min_max", [&] { MinMax m = min_max(vec); return static_cast<long long>(m.min) + m.max; });
+  time("min_max, threads", [&] { MinMax m = min_max(vec, threads); return static_cast<long long>(m.min) + m.max; });
+
+  std::cout << "sum:\n";
+  time("loop", [&] {
+    int64_t s = 0;
+    for (int v : vec) s += v;
+    return s;
+  });
+  time("sum_keys", [&] { return sum_keys(vec); });
+  time("sum_keys, threads", [&] { return sum_keys(vec, threads); });
+
+  std::cout << "argmax:\n";
+  time("std::max_element", [&] { return std::max_element(vec.begin(), vec.end()) - vec.begin(); });
+  time("argmax", [&] { return argmax(vec); });
+  time("argmax, threads", [&] { return argmax(vec, threads); });
+
+  std::cout << "(check " << check << ")\n";
 }
 
 
-std::vector<int> makeVec(int n, int max) {
-  std::vector<int> vec(n);
+// -s: mode, distinct count and top k of a generated data set, timed.
+void run_frequencies(long n, int max_val, Distribution d, unsigned seed, int threads, int k, bool sketches) {
+  std::vector<int> vec;
+  generate(vec, n, max_val, d, seed, threads);
 
-  for (int i = 0; i < n; i++) {
-    vec.at(i) = rand() % max;
+  auto start = std::chrono::steady_clock::now();
+  Frequencies f = frequencies(vec, k, threads);
+  double ms = ms_since(start);
+
+  std::cout << n << " keys, " << distribution_name(d) << ", " << threads << " threads, "
+            << (f.dense ? "dense histogram" : "hash counter") << ": " << ms << " ms\n";
+  std::cout << "Mode: " << f.mode << " (" << f.mode_count << " times)\n";
+  std::cout << "Distinct: " << f.distinct << "\n";
+  std::cout << "Top " << f.top.size() << ":";
+  for (auto & kc : f.top) {
+    std::cout << " " << kc.first << " (" << kc.second << ")";
   }
-  return vec;
+  std::cout << "\n";
+
+  if (sketches) run_sketches(vec, f, threads, k);
 }
 
 
-int main() {
+int main(int argc, char * argv[]) {
+  long n = 0;
+  int max_val = 1000000000;
+  int threads = std::thread::hardware_concurrency();
+  int k = 10;
+  unsigned seed = 42;
+  Distribution dist = UNIFORM;
+  bool sketches = false;
+  bool reductions = false;
+
+  int c;
+  while ((c = getopt(argc, argv, "hs:m:t:k:r:d:SR")) != -1) {
+    switch (c) {
+    case 's' :
+      n = std::stol(optarg);
+      break;
+    case 'm' :
+      max_val = std::stoi(optarg);
+      break;
+    case 't' :
+      threads = std::max(1, std::stoi(optarg));
+      break;
+    case 'k' :
+      k = std::max(0, std::stoi(optarg));
+      break;
+    case 'r' :
+      seed = std::stoul(optarg);
+      break;
+    case 'd' :
+      if (!parse_distribution(optarg, dist)) {
+        std::cerr << "Unknown distribution " << optarg << "\n";
+        return 1;
+      }
+      break;
+    case 'S' :
+      sketches = true;
+      break;
+    case 'R' :
+      reductions = true;
+      break;
+    case 'h' :
+      print_help(argv[0]);
+      return 0;
+    default :
+      print_help(argv[0]);
+      return 1;
+    }
+  }
+
+  if (n > 0 && reductions) {
+    std::vector<int> vec;
+    generate(vec, n, max_val, dist, seed, threads);
+    std::cout << n << " keys (" << n * sizeof(int) / 1e9 << " GB), " << distribution_name(dist) << ", "
+              << threads << " threads\n";
+    run_reductions(vec, threads);
+    return 0;
+  }
+
+  if (n > 0) {
+    run_frequencies(n, max_val, dist, seed, threads, k, sketches);
+    return 0;
+  }
+
   srand(time(nullptr));
   std::vector<int> v1 = makeVec(10, 10);
 
@@ -0,0 +1,70 @@
+#ifndef PARALLEL_MSORT_H
+#define PARALLEL_MSORT_H
+
+#include <vector>
+#include <algorithm>
+
+#include "introsort.h"
+#include "sort_kernels.h"
+#include "thread_pool.h"
+#include "merge_path.h"
+
+
+/* Parallel merge sort.
+   One scratch buffer the size of the input is allocated up front. Each
+   level sorts its two halves into the buffer the merge is *not* writing
+   to, so the data ping-pongs between the input and the scratch buffer
+   instead of being copied into fresh left/right vectors. Halves are forked
+   as tasks on a work-stealing pool, and large merges are cut into equal
+   merge path segments (merge_path.h) so the last few levels don't fall
+   back to one core. */
+
+const int PMSORT_LEAF = 2048;          // sorted with introsort
+const int PMSORT_MERGE_GRAIN = 16384;  // outputs per merge path segment
+
+
+// Merges from[l1, h1) and from[l2, h2) into to[out, ...), one merge path
+// segment of about PMSORT_MERGE_GRAIN outputs per task.
+inline void pmerge(const std::vector<int> & from, int l1, int h1,
+                   int l2, int h2, std::vector<int> & to, int out,
+                   ThreadPool & pool) {
+  size_t n = (h1 - l1) + (h2 - l2);
+  size_t segments = (n + PMSORT_MERGE_GRAIN - 1) / PMSORT_MERGE_GRAIN;
+  parallel_merge(from.data() + l1, h1 - l1, from.data() + l2, h2 - l2, to.data() + out, pool, segments);
+}
+
+
+// Sorts a[l, h). The result ends up in b when into_b is set, otherwise in a.
+inline void pmsort_rec(std::vector<int> & a, std::vector<int> & b, int l, int h,
+                       bool into_b, ThreadPool & pool) {
+  if (h - l <= PMSORT_LEAF) {
+    if (h - l > 1) introsort_range(a, l, h - 1);
+    if (into_b) std::copy(a.begin() + l, a.begin() + h, b.begin() + l);
+    return;
+  }
+
+  int m = l + (h - l) / 2;
+
+  // Both halves land in the buffer the merge reads from.
+  TaskGroup group(pool);
+  group.run([&] { pmsort_rec(a, b, l, m, !into_b, pool); });
+  pmsort_rec(a, b, m, h, !into_b, pool);
+  group.wait();
+
+  if (into_b) {
+    pmerge(a, l, m, m, h, b, l, pool);
+  } else {
+    pmerge(b, l, m, m, h, a, l, pool);
+  }
+}
+
+
+inline void parallel_msort(std::vector<int> & a, int threads) {
+  if (a.size() < 2) return;
+
+  std::vector<int> scratch(a.size());
+  ThreadPool pool(threads);
+  pmsort_rec(a, scratch, 0, a.size(), false, pool);
+}
+
+#endif // PARALLEL_MSORT_H
@@ -0,0 +1,220 @@
+#include <new>
+#include <fstream>
+#include <string>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <malloc.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "perf_counters.h"
+
+
+namespace {
+
+struct EventConfig {
+  const char * name;
+  uint32_t type;
+  uint64_t config;
+};
+
+const uint64_t L1D_READ_MISS = PERF_COUNT_HW_CACHE_L1D | PERF_COUNT_HW_CACHE_OP_READ << 8 |
+                               PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+const uint64_t LLC_READ_MISS = PERF_COUNT_HW_CACHE_LL | PERF_COUNT_HW_CACHE_OP_READ << 8 |
+                               PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+
+// Same order as enum PerfEvent.
+const EventConfig EVENTS[PERF_EVENTS] = {
+  {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+  {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+  {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+  {"l1d_misses", PERF_TYPE_HW_CACHE, L1D_READ_MISS},
+  {"llc_misses", PERF_TYPE_HW_CACHE, LLC_READ_MISS},
+  {"page_faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+};
+
+
+int open_event(const EventConfig & e) {
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = e.type;
+  attr.config = e.config;
+  attr.disabled = 1;
+  attr.inherit = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+
+std::atomic<long long> alloc_bytes{0};
+std::atomic<long long> alloc_calls{0};
+std::atomic<long long> live_bytes{0};
+std::atomic<long long> peak_bytes{0};
+
+
+void * counted_alloc(size_t bytes, size_t align) {
+  if (bytes == 0) bytes = 1;
+  void * p;
+  if (align <= alignof(std::max_align_t)) {
+    p = malloc(bytes);
+  } else {
+    p = aligned_alloc(align, (bytes + align - 1) / align * align);
+  }
+  if (p == nullptr) throw std::bad_alloc();
+
+  alloc_bytes.fetch_add(bytes, std::memory_order_relaxed);
+  alloc_calls.fetch_add(1, std::memory_order_relaxed);
+
+  // Live bytes go by block size, so a free subtracts what its alloc added.
+  long long live = live_bytes.fetch_add(malloc_usable_size(p), std::memory_order_relaxed) + malloc_usable_size(p);
+  long long peak = peak_bytes.load(std::memory_order_relaxed);
+  while (live > peak && !peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+  }
+  return p;
+}
+
+
+void counted_free(void * p) {
+  if (p == nullptr) return;
+  live_bytes.fetch_sub(malloc_usable_size(p), std::memory_order_relaxed);
+  free(p);
+}
+
+// A "Field:  1234 kB" line of /proc/self/status, in bytes.
+long long proc_status_bytes(const std::string & field) {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, field.size(), field) == 0 && line[field.size()] == ':') {
+      return std::stoll(line.substr(field.size() + 1)) * 1024;
+    }
+  }
+  return -1;
+}
+
+} // namespace
+
+
+const char * perf_event_name(int event) {
+  return event >= 0 && event < PERF_EVENTS ? EVENTS[event].name : "unknown";
+}
+
+
+PerfCounters::PerfCounters() {
+  for (int e = 0; e < PERF_EVENTS; e++) {
+    fd_[e] = open_event(EVENTS[e]);
+  }
+}
+
+
+PerfCounters::~PerfCounters() {
+  for (int e = 0; e < PERF_EVENTS; e++) {
+    if (fd_[e] >= 0) close(fd_[e]);
+  }
+}
+
+
+bool PerfCounters::available() const {
+  for (int e = 0; e < PERF_EVENTS; e++) {
+    if (fd_[e] >= 0) return true;
+  }
+  return false;
+}
+
+
+void PerfCounters::reset() {
+  for (int e = 0; e < PERF_EVENTS; e++) {
+    if (fd_[e] >= 0) ioctl(fd_[e], PERF_EVENT_IOC_RESET, 0);
+  }
+}
+
+
+void PerfCounters::start() {
+  for (int e = 0; e < PERF_EVENTS; e++) {
+    if (fd_[e] >= 0) ioctl(fd_[e], PERF_EVENT_IOC_ENABLE, 0);
+  }
+}
+
+
+void PerfCounters::stop() {
+  for (int e = 0; e < PERF_EVENTS; e++) {
+    if (fd_[e] >= 0) ioctl(fd_[e], PERF_EVENT_IOC_DISABLE, 0);
+  }
+}
+
+
+PerfSample PerfCounters::read() const {
+  PerfSample s;
+  for (int e = 0; e < PERF_EVENTS; e++) {
+    uint64_t buf[3];  // value, time enabled, time running
+    s.value[e] = -1;
+    if (fd_[e] < 0 || ::read(fd_[e], buf, sizeof(buf)) != sizeof(buf)) continue;
+
+    if (buf[2] == 0) {
+      s.value[e] = 0;
+    } else if (buf[2] < buf[1]) {
+      s.value[e] = static_cast<long long>(static_cast<double>(buf[0]) * buf[1] / buf[2]);
+    } else {
+      s.value[e] = buf[0];
+    }
+  }
+  return s;
+}
+
+
+AllocStats alloc_stats() {
+  return {alloc_bytes.load(), alloc_calls.load(), live_bytes.load(), peak_bytes.load()};
+}
+
+
+void reset_alloc_peak() {
+  peak_bytes.store(live_bytes.load());
+}
+
+
+long long current_rss() {
+  return proc_status_bytes("VmRSS");
+}
+
+
+long long peak_rss() {
+  return proc_status_bytes("VmHWM");
+}
+
+
+bool reset_peak_rss() {
+  // Hand freed heap pages back first, or a run that reuses them would
+  // not show up in the peak.
+  malloc_trim(0);
+  std::ofstream clear("/proc/self/clear_refs");
+  clear << "5";
+  clear.flush();
+  return static_cast<bool>(clear);
+}
+
+
+// The array, sized and nothrow forms call these by default.
+void * operator new(size_t bytes) {
+  return counted_alloc(bytes, 0);
+}
+
+void * operator new(size_t bytes, std::align_val_t align) {
+  return counted_alloc(bytes, static_cast<size_t>(align));
+}
+
+void operator delete(void * p) noexcept {
+  counted_free(p);
+}
+
+void operator delete(void * p, std::align_val_t) noexcept {
+  counted_free(p);
+}
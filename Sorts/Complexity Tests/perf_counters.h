@@ -0,0 +1,82 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+
+/* Measurements that back up the timings in results.md.
+
+   PerfCounters reads hardware and software counters from perf_event_open
+   around a piece of code. Each event gets its own descriptor, counting
+   user space only, and inherited by threads started while it is open so
+   the parallel modes count their workers too (a worker's counts arrive
+   when it exits). Events the kernel or the VM does not offer read -1, and
+   when the PMU is shared the counts are scaled by time enabled / running.
+   start() and stop() can be paired many times; the counts add up until
+   reset().
+
+   Resident set sizes come from /proc/self/status. reset_peak_rss() needs
+   Linux 4.0 or later; before that the peak is the whole process's.
+
+   The allocation counters come from replacing the global operator new and
+   delete (perf_counters.cpp), so every std::vector, thread and task in the
+   program is counted, and no container type has to change. */
+
+enum PerfEvent {
+  PERF_CYCLES,
+  PERF_INSTRUCTIONS,
+  PERF_BRANCH_MISSES,
+  PERF_L1D_MISSES,     // L1 data cache read misses
+  PERF_LLC_MISSES,     // last level cache read misses
+  PERF_PAGE_FAULTS,
+  PERF_EVENTS
+};
+
+const char * perf_event_name(int event);
+
+struct PerfSample {
+  long long value[PERF_EVENTS];  // -1 when the event is not available
+};
+
+
+class PerfCounters {
+public:
+  PerfCounters();
+  ~PerfCounters();
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters & operator=(const PerfCounters &) = delete;
+
+  // False when not a single event could be opened.
+  bool available() const;
+
+  void reset();
+  void start();
+  void stop();
+  PerfSample read() const;
+
+private:
+  int fd_[PERF_EVENTS];
+};
+
+
+struct AllocStats {
+  long long bytes;   // requested by operator new since program start
+  long long calls;
+  long long live;    // bytes in blocks not yet freed, by malloc block size
+  long long peak;    // most bytes live at once since reset_alloc_peak()
+};
+
+AllocStats alloc_stats();
+
+// Starts a new peak from the bytes live now.
+void reset_alloc_peak();
+
+
+// Resident set size now and its peak (VmRSS, VmHWM) in bytes, -1 if
+// /proc doesn't say.
+long long current_rss();
+long long peak_rss();
+
+// Returns free heap memory to the kernel and starts a new peak from the
+// resident set then. False if it can't.
+bool reset_peak_rss();
+
+#endif // PERF_COUNTERS_H
@@ -0,0 +1,124 @@
+#ifndef RADIX_SORT_H
+#define RADIX_SORT_H
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+
+/* Non-comparison sorts for int keys.
+   Keys are mapped to unsigned by flipping the sign bit, which keeps their
+   order and lets negative ints through both paths. counting_sort is used
+   when the key range is no bigger than the input; otherwise radix_sort
+   does LSD passes over 8-bit digits. */
+
+const int RADIX_BITS = 8;
+const int RADIX_BUCKETS = 1 << RADIX_BITS;
+const int RADIX_PASSES = 32 / RADIX_BITS;
+
+
+inline uint32_t radix_key(int x) {
+  return static_cast<uint32_t>(x) ^ 0x80000000u;
+}
+
+
+// Histogram of arr[0..n) over [lo, hi], written back in order.
+inline void counting_sort(int * arr, size_t n, int lo, int hi) {
+  std::vector<size_t> counts(static_cast<size_t>(static_cast<int64_t>(hi) - lo) + 1, 0);
+
+  for (size_t i = 0; i < n; i++) {
+    counts[static_cast<int64_t>(arr[i]) - lo]++;
+  }
+
+  size_t out = 0;
+  for (size_t k = 0; k < counts.size(); k++) {
+    std::fill(arr + out, arr + out + counts[k], static_cast<int>(lo + static_cast<int64_t>(k)));
+    out += counts[k];
+  }
+}
+
+inline void counting_sort(std::vector<int> & arr, int lo, int hi) {
+  counting_sort(arr.data(), arr.size(), lo, hi);
+}
+
+
+/* LSD radix sort.
+   One read of the input builds the histograms for every digit at once.
+   A digit whose values all fall in one bucket is skipped, which is common
+   for the high digits when keys come from rand() % max. The remaining
+   passes ping-pong between arr and scratch, which holds n ints. */
+
+inline void lsd_radix_sort(int * arr, size_t n, int * scratch) {
+  if (n < 2) return;
+
+  std::vector<size_t> counts(RADIX_PASSES * RADIX_BUCKETS, 0);
+
+  for (size_t i = 0; i < n; i++) {
+    uint32_t key = radix_key(arr[i]);
+    for (int d = 0; d < RADIX_PASSES; d++) {
+      counts[d * RADIX_BUCKETS + ((key >> (d * RADIX_BITS)) & (RADIX_BUCKETS - 1))]++;
+    }
+  }
+
+  int * from = arr;
+  int * to = scratch;
+
+  for (int d = 0; d < RADIX_PASSES; d++) {
+    size_t * count = &counts[d * RADIX_BUCKETS];
+    int shift = d * RADIX_BITS;
+
+    // Every key has the same digit here, so this pass would be a copy.
+    if (count[(radix_key(from[0]) >> shift) & (RADIX_BUCKETS - 1)] == n) continue;
+
+    // Exclusive prefix sums turn counts into bucket offsets.
+    size_t sum = 0;
+    for (int b = 0; b < RADIX_BUCKETS; b++) {
+      size_t c = count[b];
+      count[b] = sum;
+      sum += c;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+      int x = from[i];
+      to[count[(radix_key(x) >> shift) & (RADIX_BUCKETS - 1)]++] = x;
+    }
+    std::swap(from, to);
+  }
+
+  if (from != arr) {
+    std::copy(from, from + n, arr);
+  }
+}
+
+inline void lsd_radix_sort(std::vector<int> & arr) {
+  std::vector<int> scratch(arr.size());
+  lsd_radix_sort(arr.data(), arr.size(), scratch.data());
+}
+
+
+// Counting-sorts arr and returns true when its key range is small next to
+// n; otherwise leaves arr alone and returns false.
+inline bool counting_sort_if_dense(int * arr, size_t n) {
+  auto bounds = std::minmax_element(arr, arr + n);
+  int lo = *bounds.first, hi = *bounds.second;
+
+  if (static_cast<int64_t>(hi) - lo >= static_cast<int64_t>(n)) return false;
+  counting_sort(arr, n, lo, hi);
+  return true;
+}
+
+
+// Picks counting sort when the key range is small next to n, radix otherwise.
+// scratch is only touched on the radix path.
+inline void radix_sort(int * arr, size_t n, int * scratch) {
+  if (n < 2) return;
+  if (!counting_sort_if_dense(arr, n)) lsd_radix_sort(arr, n, scratch);
+}
+
+// Allocates the scratch only when the radix path needs it.
+inline void radix_sort(std::vector<int> & arr) {
+  if (arr.size() < 2) return;
+  if (!counting_sort_if_dense(arr.data(), arr.size())) lsd_radix_sort(arr);
+}
+
+#endif // RADIX_SORT_H
@@ -0,0 +1,262 @@
+#ifndef REDUCE_KERNELS_H
+#define REDUCE_KERNELS_H
+
+#include <vector>
+#include <cstdint>
+#include <climits>
+#include <algorithm>
+
+#include "sort_kernels.h"
+#include "thread_pool.h"
+
+
+/* Reductions over int arrays: count of a key, min and max, sum and the
+   first index of the max. They read each key once and do a few vector
+   ops on it, so past the caches they run at memory bandwidth. The vector
+   path follows sort_kernels.h: AVX2 (8 lanes), SSE4.1 (4 lanes) or, with
+   neither or with -DSORT_KERNELS_SCALAR, plain loops.
+   - count: compares set a lane to -1, which is subtracted from per-lane
+     32-bit counts. These are flushed to 64 bits before they can wrap.
+   - sum: 64-bit lanes, so no input can overflow it.
+   - argmax: one pass keeps the max of each REDUCE_BLOCK-key block and the
+     first block holding the overall max, then searches just that block.
+   The threads forms give each thread an equal stripe once n reaches
+   REDUCE_PARALLEL_MIN, and combine the answers in stripe order, so
+   ties resolve the same way as on one thread. */
+
+const size_t REDUCE_PARALLEL_MIN = 1 << 20;  // fewer keys: one thread
+const size_t REDUCE_BLOCK = 4096;            // argmax block; also the count flush interval
+
+
+struct MinMax {
+  int min;  // INT_MAX and INT_MIN for no keys
+  int max;
+};
+
+
+#if defined(SORT_KERNELS_AVX2)
+
+inline int hmin(__m256i v) {
+  __m128i m = _mm_min_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+  m = _mm_min_epi32(m, _mm_shuffle_epi32(m, 0x4E));
+  m = _mm_min_epi32(m, _mm_shuffle_epi32(m, 0xB1));
+  return _mm_cvtsi128_si32(m);
+}
+
+inline int hmax(__m256i v) {
+  __m128i m = _mm_max_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+  m = _mm_max_epi32(m, _mm_shuffle_epi32(m, 0x4E));
+  m = _mm_max_epi32(m, _mm_shuffle_epi32(m, 0xB1));
+  return _mm_cvtsi128_si32(m);
+}
+
+inline int64_t hsum32(__m256i v) {
+  int32_t lanes[8];
+  _mm256_storeu_si256((__m256i *) lanes, v);
+  int64_t s = 0;
+  for (int32_t x : lanes) s += static_cast<uint32_t>(x);  // counts, never negative
+  return s;
+}
+
+inline int64_t hsum64(__m256i v) {
+  int64_t lanes[4];
+  _mm256_storeu_si256((__m256i *) lanes, v);
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+#elif defined(SORT_KERNELS_SSE4)
+
+inline int hmin(__m128i m) {
+  m = _mm_min_epi32(m, _mm_shuffle_epi32(m, 0x4E));
+  m = _mm_min_epi32(m, _mm_shuffle_epi32(m, 0xB1));
+  return _mm_cvtsi128_si32(m);
+}
+
+inline int hmax(__m128i m) {
+  m = _mm_max_epi32(m, _mm_shuffle_epi32(m, 0x4E));
+  m = _mm_max_epi32(m, _mm_shuffle_epi32(m, 0xB1));
+  return _mm_cvtsi128_si32(m);
+}
+
+inline int64_t hsum32(__m128i v) {
+  int32_t lanes[4];
+  _mm_storeu_si128((__m128i *) lanes, v);
+  return static_cast<int64_t>(static_cast<uint32_t>(lanes[0])) + static_cast<uint32_t>(lanes[1]) +
+         static_cast<uint32_t>(lanes[2]) + static_cast<uint32_t>(lanes[3]);
+}
+
+inline int64_t hsum64(__m128i v) {
+  int64_t lanes[2];
+  _mm_storeu_si128((__m128i *) lanes, v);
+  return lanes[0] + lanes[1];
+}
+
+#endif
+
+
+// Keys equal to x in a[0..n).
+inline size_t count_equal(const int * a, size_t n, int x) {
+  size_t count = 0, i = 0;
+#if defined(SORT_KERNELS_AVX2)
+  __m256i key = _mm256_set1_epi32(x);
+  while (n - i >= 16) {
+    __m256i c0 = _mm256_setzero_si256(), c1 = _mm256_setzero_si256();
+    size_t end = i + std::min(n - i, REDUCE_BLOCK * 16) / 16 * 16;
+    for (; i < end; i += 16) {
+      c0 = _mm256_sub_epi32(c0, _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *) (a + i)), key));
+      c1 = _mm256_sub_epi32(c1, _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *) (a + i + 8)), key));
+    }
+    count += hsum32(_mm256_add_epi32(c0, c1));
+  }
+#elif defined(SORT_KERNELS_SSE4)
+  __m128i key = _mm_set1_epi32(x);
+  while (n - i >= 8) {
+    __m128i c0 = _mm_setzero_si128(), c1 = _mm_setzero_si128();
+    size_t end = i + std::min(n - i, REDUCE_BLOCK * 8) / 8 * 8;
+    for (; i < end; i += 8) {
+      c0 = _mm_sub_epi32(c0, _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) (a + i)), key));
+      c1 = _mm_sub_epi32(c1, _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) (a + i + 4)), key));
+    }
+    count += hsum32(_mm_add_epi32(c0, c1));
+  }
+#endif
+  for (; i < n; i++) {
+    count += a[i] == x;
+  }
+  return count;
+}
+
+
+inline MinMax min_max(const int * a, size_t n) {
+  MinMax m = {INT_MAX, INT_MIN};
+  size_t i = 0;
+#if defined(SORT_KERNELS_AVX2)
+  if (n >= 8) {
+    __m256i lo = _mm256_loadu_si256((const __m256i *) a), hi = lo;
+    for (i = 8; i + 8 <= n; i += 8) {
+      __m256i v = _mm256_loadu_si256((const __m256i *) (a + i));
+      lo = _mm256_min_epi32(lo, v);
+      hi = _mm256_max_epi32(hi, v);
+    }
+    m = {hmin(lo), hmax(hi)};
+  }
+#elif defined(SORT_KERNELS_SSE4)
+  if (n >= 4) {
+    __m128i lo = _mm_loadu_si128((const __m128i *) a), hi = lo;
+    for (i = 4; i + 4 <= n; i += 4) {
+      __m128i v = _mm_loadu_si128((const __m128i *) (a + i));
+      lo = _mm_min_epi32(lo, v);
+      hi = _mm_max_epi32(hi, v);
+    }
+    m = {hmin(lo), hmax(hi)};
+  }
+#endif
+  for (; i < n; i++) {
+    m.min = std::min(m.min, a[i]);
+    m.max = std::max(m.max, a[i]);
+  }
+  return m;
+}
+
+
+inline int64_t sum_keys(const int * a, size_t n) {
+  int64_t s = 0;
+  size_t i = 0;
+#if defined(SORT_KERNELS_AVX2)
+  __m256i s0 = _mm256_setzero_si256(), s1 = _mm256_setzero_si256();
+  for (; i + 8 <= n; i += 8) {
+    __m256i v = _mm256_loadu_si256((const __m256i *) (a + i));
+    s0 = _mm256_add_epi64(s0, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+    s1 = _mm256_add_epi64(s1, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+  }
+  s = hsum64(_mm256_add_epi64(s0, s1));
+#elif defined(SORT_KERNELS_SSE4)
+  __m128i s0 = _mm_setzero_si128(), s1 = _mm_setzero_si128();
+  for (; i + 4 <= n; i += 4) {
+    __m128i v = _mm_loadu_si128((const __m128i *) (a + i));
+    s0 = _mm_add_epi64(s0, _mm_cvtepi32_epi64(v));
+    s1 = _mm_add_epi64(s1, _mm_cvtepi32_epi64(_mm_shuffle_epi32(v, 0x4E)));
+  }
+  s = hsum64(_mm_add_epi64(s0, s1));
+#endif
+  for (; i < n; i++) {
+    s += a[i];
+  }
+  return s;
+}
+
+
+// Index of the first max of a[0..n); n if n == 0.
+inline size_t argmax(const int * a, size_t n) {
+  if (n == 0) return 0;
+  size_t best_block = 0;
+  int best = INT_MIN;
+
+  for (size_t b = 0; b < n; b += REDUCE_BLOCK) {
+    int m = min_max(a + b, std::min(REDUCE_BLOCK, n - b)).max;
+    if (m > best) {
+      best = m;
+      best_block = b;
+    }
+  }
+
+  size_t i = best_block;
+  while (a[i] != best) i++;
+  return i;
+}
+
+
+// The threads forms. Each thread reduces a stripe; combine folds the
+// stripe results in order.
+template <typename T, typename Reduce, typename Combine>
+T reduce_stripes(size_t n, int threads, Reduce reduce, Combine combine) {
+  if (threads < 1 || n < REDUCE_PARALLEL_MIN) threads = 1;
+  size_t stripe = (n + threads - 1) / threads;
+  if (threads == 1) return reduce(0, n);
+
+  std::vector<T> part(threads);
+  {
+    ThreadPool pool(threads);
+    TaskGroup group(pool);
+    for (int t = 0; t < threads; t++) {
+      group.run([&, t] {
+        size_t begin = std::min(n, t * stripe);
+        part[t] = reduce(begin, std::min(n, begin + stripe));
+      });
+    }
+  }
+
+  T result = part[0];
+  for (int t = 1; t < threads; t++) {
+    result = combine(result, part[t]);
+  }
+  return result;
+}
+
+
+inline size_t count_equal(const std::vector<int> & a, int x, int threads = 1) {
+  return reduce_stripes<size_t>(
+      a.size(), threads, [&](size_t b, size_t e) { return count_equal(a.data() + b, e - b, x); },
+      [](size_t p, size_t q) { return p + q; });
+}
+
+inline MinMax min_max(const std::vector<int> & a, int threads = 1) {
+  return reduce_stripes<MinMax>(
+      a.size(), threads, [&](size_t b, size_t e) { return min_max(a.data() + b, e - b); },
+      [](MinMax p, MinMax q) { return MinMax{std::min(p.min, q.min), std::max(p.max, q.max)}; });
+}
+
+inline int64_t sum_keys(const std::vector<int> & a, int threads = 1) {
+  return reduce_stripes<int64_t>(
+      a.size(), threads, [&](size_t b, size_t e) { return sum_keys(a.data() + b, e - b); },
+      [](int64_t p, int64_t q) { return p + q; });
+}
+
+// An empty stripe reports its end, which no later stripe's max can lose to.
+inline size_t argmax(const std::vector<int> & a, int threads = 1) {
+  return reduce_stripes<size_t>(
+      a.size(), threads, [&](size_t b, size_t e) { return b == e ? a.size() : b + argmax(a.data() + b, e - b); },
+      [&](size_t p, size_t q) { return q < a.size() && (p == a.size() || a[q] > a[p]) ? q : p; });
+}
+
+#endif // REDUCE_KERNELS_H
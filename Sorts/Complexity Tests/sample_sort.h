@@ -0,0 +1,181 @@
+#ifndef SAMPLE_SORT_H
+#define SAMPLE_SORT_H
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include "introsort.h"
+#include "block_partition.h"
+#include "thread_pool.h"
+
+
+/* Parallel super scalar sample sort (Sanders and Winkel).
+   1. Draw SAMPLE_OVERSAMPLE keys per bucket, sort them and keep every
+      SAMPLE_OVERSAMPLE-th as a splitter, dropping duplicates.
+   2. Each thread classifies its stripe of the input by walking an implicit
+      binary tree of splitters. The next node is 2i + (splitter < x), so the
+      descent has no branches. The bucket of every key is kept in an
+      oracle array, and each thread counts its own bucket sizes.
+   3. Prefix sums over (bucket, thread) give every thread its own slice of
+      each bucket, and the threads scatter their stripes in parallel.
+   4. Buckets are copied back and sorted as independent pool tasks.
+   Keys equal to a splitter go to an equality bucket of their own, which is
+   already sorted. A key that fills most of the input (few unique values,
+   Zipf) therefore costs one pass instead of a lopsided bucket. */
+
+const int SAMPLE_SORT_MIN = 1 << 15;    // smaller inputs: block quicksort
+const int SAMPLE_MAX_LOG_BUCKETS = 8;   // up to 256 ranges, 512 buckets
+const int SAMPLE_OVERSAMPLE = 32;
+
+
+// Splitter tree over sorted, distinct splitters. Bucket 2b holds keys in
+// (s[b-1], s[b]), and bucket 2b + 1 the keys equal to s[b].
+class SplitterTree {
+public:
+  explicit SplitterTree(std::vector<int> splitters) {
+    log_k_ = 1;
+    while ((1 << log_k_) < static_cast<int>(splitters.size()) + 1) log_k_++;
+    int k = 1 << log_k_;
+
+    // Pad with copies of the largest splitter; the buckets between the
+    // copies stay empty.
+    splitters.resize(k - 1, splitters.back());
+    sorted_ = splitters;
+    sorted_.push_back(splitters.back());  // last range: keys above all splitters
+
+    tree_.resize(k);
+    build(splitters, 1, 0, k - 1);
+  }
+
+  int buckets() const { return 2 << log_k_; }
+
+  int bucket(int x) const {
+    int i = 1;
+    for (int l = 0; l < log_k_; l++) {
+      i = 2 * i + (tree_[i] < x);
+    }
+    int b = i - (1 << log_k_);
+    return 2 * b + (x == sorted_[b]);
+  }
+
+private:
+  int log_k_;
+  std::vector<int> tree_;    // heap order, node i's children are 2i, 2i + 1
+  std::vector<int> sorted_;
+
+  void build(const std::vector<int> & s, int node, int lo, int hi) {
+    if (node >= static_cast<int>(tree_.size())) return;
+    int mid = lo + (hi - lo) / 2;
+    tree_[node] = s[mid];
+    build(s, 2 * node, lo, mid);
+    build(s, 2 * node + 1, mid + 1, hi);
+  }
+};
+
+
+// Up to 2^log_k - 1 distinct splitters from an oversampled, sorted sample.
+inline std::vector<int> choose_splitters(const std::vector<int> & a, int log_k) {
+  int k = 1 << log_k;
+  size_t n = a.size();
+  std::vector<int> sample(k * SAMPLE_OVERSAMPLE);
+
+  // splitmix64 positions: reproducible, and not fooled by periodic inputs.
+  uint64_t state = 0x9E3779B97F4A7C15ull ^ n;
+  for (int & s : sample) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    s = a[(z ^ (z >> 31)) % n];
+  }
+  introsort(sample);
+
+  std::vector<int> splitters;
+  for (int i = 1; i < k; i++) {
+    int s = sample[i * SAMPLE_OVERSAMPLE - 1];
+    if (splitters.empty() || splitters.back() != s) splitters.push_back(s);
+  }
+  return splitters;
+}
+
+
+inline void sample_sort(std::vector<int> & a, int threads) {
+  size_t n = a.size();
+  if (threads < 1) threads = 1;
+  if (n < static_cast<size_t>(SAMPLE_SORT_MIN)) {
+    if (n > 1) block_qsort(a);
+    return;
+  }
+
+  // About 2^14 keys per range keeps each bucket's sort in cache.
+  int log_k = 1;
+  while (log_k < SAMPLE_MAX_LOG_BUCKETS && (n >> (log_k + 14)) > 0) log_k++;
+
+  SplitterTree tree(choose_splitters(a, log_k));
+  int buckets = tree.buckets();
+
+  std::vector<uint16_t> oracle(n);
+  std::vector<size_t> counts(static_cast<size_t>(threads) * buckets, 0);
+  size_t stripe = (n + threads - 1) / threads;
+
+  ThreadPool pool(threads);
+
+  {
+    TaskGroup group(pool);
+    for (int t = 0; t < threads; t++) {
+      group.run([&, t] {
+        size_t * count = &counts[static_cast<size_t>(t) * buckets];
+        size_t end = std::min(n, (t + 1) * stripe);
+        for (size_t i = t * stripe; i < end; i++) {
+          int b = tree.bucket(a[i]);
+          oracle[i] = b;
+          count[b]++;
+        }
+      });
+    }
+  }
+
+  // Exclusive prefix sums, bucket-major, so thread t writes its keys of
+  // bucket b right after those of threads 0..t-1.
+  std::vector<size_t> bucket_start(buckets + 1);
+  size_t sum = 0;
+  for (int b = 0; b < buckets; b++) {
+    bucket_start[b] = sum;
+    for (int t = 0; t < threads; t++) {
+      size_t c = counts[static_cast<size_t>(t) * buckets + b];
+      counts[static_cast<size_t>(t) * buckets + b] = sum;
+      sum += c;
+    }
+  }
+  bucket_start[buckets] = n;
+
+  std::vector<int> scratch(n);
+  {
+    TaskGroup group(pool);
+    for (int t = 0; t < threads; t++) {
+      group.run([&, t] {
+        size_t * offset = &counts[static_cast<size_t>(t) * buckets];
+        size_t end = std::min(n, (t + 1) * stripe);
+        for (size_t i = t * stripe; i < end; i++) {
+          scratch[offset[oracle[i]]++] = a[i];
+        }
+      });
+    }
+  }
+
+  // Copy each bucket home and sort it there; equality buckets are done.
+  {
+    TaskGroup group(pool);
+    for (int b = 0; b < buckets; b++) {
+      size_t l = bucket_start[b], h = bucket_start[b + 1];
+      if (l == h) continue;
+
+      group.run([&, b, l, h] {
+        std::copy(scratch.begin() + l, scratch.begin() + h, a.begin() + l);
+        if (b % 2 == 0 && h - l > 1) introsort_range(a, l, h - 1, block_partition);
+      });
+    }
+  }
+}
+
+#endif // SAMPLE_SORT_H
@@ -0,0 +1,163 @@
+#ifndef SELECT_H
+#define SELECT_H
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <cmath>
+
+#include "introsort.h"
+#include "sort_kernels.h"
+
+
+/* Selection without a full sort.
+   - select_kth: introselect. Quickselect on the introsort partitions, and
+     once 2*log2(n) partitions have gone by without finishing, pivots come
+     from the median of medians of groups of 5, which guarantees O(n).
+   - multiselect: several ranks at once. It selects the middle rank, then
+     recurses into each side with only the ranks that fall there, which is
+     O(n log m) for m ranks instead of m separate O(n) passes.
+   - TopK: the k largest of a stream in a min-heap of size k, O(n log k)
+     time and O(k) memory. */
+
+const int SELECT_GROUP = 5;
+
+
+inline void select_loop(std::vector<int> & arr, int l, int h, int k, int depth,
+                        partition_fn partition);
+
+
+// Gathers the median of each group of 5 at the front of arr[l..h] and
+// returns the position of the median of those medians.
+inline int median_of_medians(std::vector<int> & arr, int l, int h) {
+  int m = l;
+
+  for (int g = l; g <= h; g += SELECT_GROUP) {
+    int gh = std::min(g + SELECT_GROUP - 1, h);
+    small_sort(&arr[g], gh - g + 1);
+    std::swap(arr[m++], arr[g + (gh - g) / 2]);
+  }
+
+  int mid = l + (m - 1 - l) / 2;
+  select_loop(arr, l, m - 1, mid, 0, intro_partition);
+  return mid;
+}
+
+
+// Moves the k-th smallest of arr[l..h] to arr[k], with nothing larger
+// before it and nothing smaller after. depth 0 means median of medians
+// from the start.
+inline void select_loop(std::vector<int> & arr, int l, int h, int k, int depth,
+                        partition_fn partition) {
+  while (h - l + 1 > INTRO_SMALL_CUTOFF) {
+    int p;
+    if (depth == 0) {
+      std::swap(arr[l], arr[median_of_medians(arr, l, h)]);
+      p = pivot_partition(arr, l, h);
+    } else {
+      depth--;
+      p = partition(arr, l, h);
+    }
+
+    if (k == p) return;
+    if (k < p) {
+      h = p - 1;
+    } else {
+      l = p + 1;
+    }
+  }
+  if (h > l) small_sort(&arr[l], h - l + 1);
+}
+
+
+// nth_element: arr[k] ends up as in sorted order, partitioned around it.
+inline int select_kth(std::vector<int> & arr, int k, partition_fn partition = intro_partition) {
+  int n = arr.size();
+  int depth = 0;
+  for (int m = n; m > 1; m >>= 1) {
+    depth += 2;
+  }
+  select_loop(arr, 0, n - 1, k, depth, partition);
+  return arr[k];
+}
+
+
+inline void multiselect_rec(std::vector<int> & arr, int l, int h, const std::vector<int> & ks,
+                            int klo, int khi, int depth) {
+  if (klo > khi || l >= h) return;
+
+  int mid = klo + (khi - klo) / 2;
+  int k = ks[mid];
+  select_loop(arr, l, h, k, depth, intro_partition);
+
+  multiselect_rec(arr, l, k - 1, ks, klo, mid - 1, depth);
+  multiselect_rec(arr, k + 1, h, ks, mid + 1, khi, depth);
+}
+
+
+// Puts every rank in ks at its sorted position in one pass.
+inline void multiselect(std::vector<int> & arr, std::vector<int> ks) {
+  std::sort(ks.begin(), ks.end());
+  ks.erase(std::unique(ks.begin(), ks.end()), ks.end());
+
+  int depth = 0;
+  for (int m = arr.size(); m > 1; m >>= 1) {
+    depth += 2;
+  }
+  multiselect_rec(arr, 0, arr.size() - 1, ks, 0, ks.size() - 1, depth);
+}
+
+
+// Nearest-rank index of percentile p (0..100) in n sorted keys.
+inline int percentile_rank(double p, int n) {
+  int rank = static_cast<int>(std::ceil(p / 100.0 * n));
+  return std::min(std::max(rank, 1), n) - 1;
+}
+
+
+// Percentiles of arr by multiselect; arr is reordered.
+inline std::vector<int> percentiles(std::vector<int> & arr, const std::vector<double> & ps) {
+  std::vector<int> ks;
+  for (double p : ps) {
+    ks.push_back(percentile_rank(p, arr.size()));
+  }
+  multiselect(arr, ks);
+
+  std::vector<int> values;
+  for (int k : ks) {
+    values.push_back(arr[k]);
+  }
+  return values;
+}
+
+
+// The k largest keys seen so far. The heap root is the smallest of them,
+// so most keys of a long stream are turned away with one comparison.
+class TopK {
+public:
+  explicit TopK(int k) : k_(k) { heap_.reserve(k); }
+
+  void push(int x) {
+    if (static_cast<int>(heap_.size()) < k_) {
+      heap_.push_back(x);
+      std::push_heap(heap_.begin(), heap_.end(), std::greater<int>());
+    } else if (k_ > 0 && x > heap_.front()) {
+      std::pop_heap(heap_.begin(), heap_.end(), std::greater<int>());
+      heap_.back() = x;
+      std::push_heap(heap_.begin(), heap_.end(), std::greater<int>());
+    }
+  }
+
+  // Largest first.
+  std::vector<int> result() const {
+    std::vector<int> out = heap_;
+    std::sort(out.begin(), out.end(), std::greater<int>());
+    return out;
+  }
+
+private:
+  int k_;
+  std::vector<int> heap_;
+};
+
+#endif // SELECT_H
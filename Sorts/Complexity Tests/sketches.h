@@ -0,0 +1,333 @@
+#ifndef SKETCHES_H
+#define SKETCHES_H
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cmath>
+#include <numbers>
+#include <algorithm>
+
+#include "frequency.h"     // FIBONACCI_HASH
+#include "thread_pool.h"
+
+
+/* Streaming frequency sketches for feeds that never end. Unlike
+   frequency.h, they never hold the whole input, and each one has a fixed
+   size picked up front:
+   - MisraGries: the heavy hitters in m counters. When they are all taken,
+     the median count is subtracted from all of them, as in the Apache
+     DataSketches frequent items sketch. Any key seen more than about
+     2 total / m times is kept, and each count is off by at most its
+     error field. SpaceSaving (Metwally et al.) gives the same bounds, but
+     it replaces the least counted key on every miss, and for a feed of
+     mostly new keys that meant a heap and index update per key. It ran
+     7x slower here.
+   - CountMinSketch (Cormode and Muthukrishnan): the count of any key,
+     overestimated by at most epsilon * total with probability 1 - delta,
+     in e / epsilon x ln(1 / delta) counters.
+   - HyperLogLog (Flajolet et al.): the distinct count, with relative
+     standard error 1.04 / sqrt(2^p), in 2^p one-byte registers.
+   Each takes one key or a block of keys. Count-min's block form hashes the
+   block once and then updates one row at a time, so each row stays in
+   cache, 10 to 25% faster than key by key here. Adding up a block's
+   duplicates before Misra-Gries saw them cost more than it saved, even on
+   Zipf keys, so its block form is a plain loop. Two sketches of the same
+   shape merge into one that summarizes both streams, so each thread can
+   keep its own and merge at the end (parallel_update). */
+
+const size_t SKETCH_BLOCK = 4096;  // keys per block in parallel_update
+
+
+// splitmix64's finalizer: a full 64-bit mix of a key.
+inline uint64_t mix64(uint64_t z) {
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+
+class MisraGries {
+public:
+  struct Item {
+    int key;
+    uint64_t count;  // the true count lies in [count - error, count]
+    uint64_t error;
+  };
+
+  explicit MisraGries(size_t counters) : counters_(std::max<size_t>(counters, 2)) {
+    size_t slots = 1;
+    while (slots < 2 * counters_) slots *= 2;
+    keys_.resize(slots);
+    counts_.assign(slots, 0);
+    mask_ = slots - 1;
+    shift_ = 64 - __builtin_ctzll(slots);
+  }
+
+  MisraGries empty_like() const { return MisraGries(counters_); }
+
+  void update(int key, uint64_t count = 1) {
+    total_ += count;
+    add(key, count);
+  }
+
+  void update(const int * keys, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      add(keys[i], 1);
+    }
+    total_ += n;
+  }
+
+  // Afterwards this summarizes both streams, with the same guarantees
+  // (Agarwal et al., "Mergeable summaries").
+  void merge(const MisraGries & other) {
+    for (size_t i = 0; i < other.counts_.size(); i++) {
+      if (other.counts_[i] != 0) add(other.keys_[i], other.counts_[i]);
+    }
+    offset_ += other.offset_;
+    total_ += other.total_;
+  }
+
+  // The k most counted keys, most first.
+  std::vector<Item> top(size_t k) const {
+    std::vector<Item> items;
+    for (size_t i = 0; i < counts_.size(); i++) {
+      if (counts_[i] != 0) items.push_back({keys_[i], counts_[i] + offset_, offset_});
+    }
+    size_t keep = std::min(k, items.size());
+    std::partial_sort(items.begin(), items.begin() + keep, items.end(), by_count);
+    items.resize(keep);
+    return items;
+  }
+
+  uint64_t total() const { return total_; }
+  size_t bytes() const { return keys_.size() * (sizeof(int) + sizeof(uint64_t)); }
+
+private:
+  size_t counters_;
+  std::vector<int> keys_;
+  std::vector<uint64_t> counts_;  // 0: empty slot
+  size_t mask_;
+  int shift_;
+  size_t size_ = 0;
+  uint64_t offset_ = 0;           // subtracted from every counter so far
+  uint64_t total_ = 0;
+
+  // Higher count first, then smaller key.
+  static bool by_count(const Item & a, const Item & b) {
+    return a.count > b.count || (a.count == b.count && a.key < b.key);
+  }
+
+  size_t find(int key) const {
+    size_t i = (static_cast<uint32_t>(key) * FIBONACCI_HASH) >> shift_;
+    while (counts_[i] != 0 && keys_[i] != key) {
+      i = (i + 1) & mask_;
+    }
+    return i;
+  }
+
+  void add(int key, uint64_t count) {
+    size_t i = find(key);
+    if (counts_[i] == 0) {
+      if (size_ == counters_) {
+        purge();
+        i = find(key);
+      }
+      keys_[i] = key;
+      size_++;
+    }
+    counts_[i] += count;
+  }
+
+  // Subtracts the median count from every counter and drops the ones that
+  // reach zero, so at least half the counters free up. A purge costs
+  // O(counters) and comes at most once per counters / 2 new keys.
+  void purge() {
+    std::vector<uint64_t> counts;
+    std::vector<std::pair<int, uint64_t>> kept;
+    for (uint64_t c : counts_) {
+      if (c != 0) counts.push_back(c);
+    }
+    std::nth_element(counts.begin(), counts.begin() + counts.size() / 2, counts.end());
+    uint64_t median = counts[counts.size() / 2];
+
+    for (size_t i = 0; i < counts_.size(); i++) {
+      if (counts_[i] > median) kept.emplace_back(keys_[i], counts_[i] - median);
+    }
+    std::fill(counts_.begin(), counts_.end(), 0);
+    size_ = 0;
+    for (auto & kc : kept) {
+      size_t i = find(kc.first);
+      keys_[i] = kc.first;
+      counts_[i] = kc.second;
+      size_++;
+    }
+    offset_ += median;
+  }
+};
+
+
+class CountMinSketch {
+public:
+  // width is rounded up to a power of two, at least 2 so that column()
+  // never shifts by 64.
+  CountMinSketch(size_t width, int depth, uint64_t seed = 0x2545F4914F6CDD1Dull)
+      : depth_(std::max(depth, 1)), seed_(seed) {
+    width_ = 2;
+    while (width_ < width) width_ *= 2;
+    shift_ = 64 - __builtin_ctzll(width_);
+    counts_.assign(width_ * depth_, 0);
+    for (int r = 0; r < depth_; r++) {
+      multipliers_.push_back(mix64(seed_ + r) | 1);
+    }
+  }
+
+  // Off by at most epsilon * total, except with probability delta.
+  static CountMinSketch with_error(double epsilon, double delta) {
+    return CountMinSketch(static_cast<size_t>(std::ceil(std::numbers::e / epsilon)),
+                          static_cast<int>(std::ceil(std::log(1 / delta))));
+  }
+
+  CountMinSketch empty_like() const { return CountMinSketch(width_, depth_, seed_); }
+
+  void update(int key, uint64_t count = 1) {
+    uint64_t h = mix64(static_cast<uint32_t>(key));
+    for (int r = 0; r < depth_; r++) {
+      counts_[r * width_ + column(h, r)] += count;
+    }
+    total_ += count;
+  }
+
+  // Hashes the block once, then one row at a time.
+  void update(const int * keys, size_t n) {
+    hashes_.resize(n);
+    for (size_t i = 0; i < n; i++) {
+      hashes_[i] = mix64(static_cast<uint32_t>(keys[i]));
+    }
+    for (int r = 0; r < depth_; r++) {
+      uint64_t * row = &counts_[r * width_];
+      for (size_t i = 0; i < n; i++) {
+        row[column(hashes_[i], r)]++;
+      }
+    }
+    total_ += n;
+  }
+
+  // Never below the true count.
+  uint64_t estimate(int key) const {
+    uint64_t h = mix64(static_cast<uint32_t>(key));
+    uint64_t best = UINT64_MAX;
+    for (int r = 0; r < depth_; r++) {
+      best = std::min(best, counts_[r * width_ + column(h, r)]);
+    }
+    return best;
+  }
+
+  // other must have the same width, depth and seed.
+  void merge(const CountMinSketch & other) {
+    for (size_t i = 0; i < counts_.size(); i++) {
+      counts_[i] += other.counts_[i];
+    }
+    total_ += other.total_;
+  }
+
+  uint64_t total() const { return total_; }
+  size_t bytes() const { return counts_.size() * sizeof(uint64_t); }
+
+private:
+  size_t width_;
+  int depth_;
+  int shift_;
+  uint64_t seed_;
+  std::vector<uint64_t> counts_;       // depth_ rows of width_
+  std::vector<uint64_t> multipliers_;  // one odd multiplier per row
+  std::vector<uint64_t> hashes_;       // scratch for the block form
+  uint64_t total_ = 0;
+
+  // Multiply-shift of the mixed key, a different multiplier per row.
+  size_t column(uint64_t h, int r) const {
+    return (h * multipliers_[r]) >> shift_;
+  }
+};
+
+
+class HyperLogLog {
+public:
+  // 2^precision registers, precision in [4, 18].
+  explicit HyperLogLog(int precision = 14) : p_(std::clamp(precision, 4, 18)), registers_(1 << p_, 0) {}
+
+  HyperLogLog empty_like() const { return HyperLogLog(p_); }
+
+  void update(int key) {
+    uint64_t h = mix64(static_cast<uint32_t>(key));
+    size_t r = h >> (64 - p_);
+    // Leading zeros after the index bits, plus one. The guard bit caps it
+    // at 64 - p + 1.
+    uint8_t rank = static_cast<uint8_t>(__builtin_clzll((h << p_) | (1ull << (p_ - 1))) + 1);
+    registers_[r] = std::max(registers_[r], rank);
+  }
+
+  void update(const int * keys, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      update(keys[i]);
+    }
+  }
+
+  void merge(const HyperLogLog & other) {
+    for (size_t i = 0; i < registers_.size(); i++) {
+      registers_[i] = std::max(registers_[i], other.registers_[i]);
+    }
+  }
+
+  // Harmonic mean of the registers, with linear counting for small counts.
+  // The 64-bit hash needs no large-range correction.
+  double estimate() const {
+    double m = registers_.size();
+    double sum = 0;
+    int zeros = 0;
+    for (uint8_t r : registers_) {
+      sum += std::ldexp(1.0, -r);
+      zeros += r == 0;
+    }
+    double e = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+    if (e <= 2.5 * m && zeros > 0) {
+      e = m * std::log(m / zeros);
+    }
+    return e;
+  }
+
+  size_t bytes() const { return registers_.size(); }
+
+private:
+  int p_;
+  std::vector<uint8_t> registers_;
+};
+
+
+// Feeds keys[0..n) to sketch on threads threads. Each thread updates its
+// own empty copy, block by block, and the copies are merged into sketch.
+template <typename Sketch>
+void parallel_update(Sketch & sketch, const int * keys, size_t n, int threads) {
+  if (threads < 1) threads = 1;
+  size_t stripe = (n + threads - 1) / threads;
+  std::vector<Sketch> local(threads, sketch.empty_like());
+
+  {
+    ThreadPool pool(threads);
+    TaskGroup group(pool);
+    for (int t = 0; t < threads; t++) {
+      group.run([&, t] {
+        size_t end = std::min(n, (t + 1) * stripe);
+        for (size_t i = t * stripe; i < end; i += SKETCH_BLOCK) {
+          local[t].update(keys + i, std::min(SKETCH_BLOCK, end - i));
+        }
+      });
+    }
+  }
+
+  for (const Sketch & s : local) {
+    sketch.merge(s);
+  }
+}
+
+#endif // SKETCHES_H
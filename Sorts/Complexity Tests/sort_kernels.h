@@ -0,0 +1,265 @@
+#ifndef SORT_KERNELS_H
+#define SORT_KERNELS_H
+
+#include <cstddef>
+#include <climits>
+#include <algorithm>
+
+#if defined(__AVX2__) && !defined(SORT_KERNELS_SCALAR)
+#include <immintrin.h>
+#define SORT_KERNELS_AVX2
+#elif defined(__SSE4_1__) && !defined(SORT_KERNELS_SCALAR)
+#include <smmintrin.h>
+#define SORT_KERNELS_SSE4
+#endif
+
+
+/* Branch-free kernels for the bottom of the sorts.
+   - sort_network<N>: bitonic sorting network over a block of 8, 16 or 32
+     ints, done in registers.
+   - merge_sorted: merges two sorted runs W elements at a time with a
+     bitonic merge network (W = 8 on AVX2, 4 on SSE4.1).
+   - small_sort: sorts up to 32 ints by padding them into a network block.
+   Build with -march=native to get the vector paths; without AVX2/SSE4.1,
+   or with -DSORT_KERNELS_SCALAR, the same networks run on plain ints. */
+
+#if defined(SORT_KERNELS_AVX2)
+
+typedef __m256i simd_vec;
+const int SIMD_WIDTH = 8;
+
+inline simd_vec simd_load(const int * p) { return _mm256_loadu_si256((const __m256i *) p); }
+inline void simd_store(int * p, simd_vec v) { _mm256_storeu_si256((__m256i *) p, v); }
+inline simd_vec simd_min(simd_vec a, simd_vec b) { return _mm256_min_epi32(a, b); }
+inline simd_vec simd_max(simd_vec a, simd_vec b) { return _mm256_max_epi32(a, b); }
+inline simd_vec simd_lanes() { return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); }
+inline simd_vec simd_set1(int x) { return _mm256_set1_epi32(x); }
+inline simd_vec simd_and(simd_vec a, simd_vec b) { return _mm256_and_si256(a, b); }
+inline simd_vec simd_xor(simd_vec a, simd_vec b) { return _mm256_xor_si256(a, b); }
+inline simd_vec simd_add(simd_vec a, simd_vec b) { return _mm256_add_epi32(a, b); }
+inline simd_vec simd_is_zero(simd_vec a) { return _mm256_cmpeq_epi32(a, _mm256_setzero_si256()); }
+inline simd_vec simd_select(simd_vec a, simd_vec b, simd_vec mask) { return _mm256_blendv_epi8(a, b, mask); }
+
+// Lane i gets lane i ^ j.
+inline simd_vec simd_partner(simd_vec v, int j) {
+  return _mm256_permutevar8x32_epi32(v, _mm256_xor_si256(simd_lanes(), _mm256_set1_epi32(j)));
+}
+
+inline simd_vec simd_reverse(simd_vec v) {
+  return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+#elif defined(SORT_KERNELS_SSE4)
+
+typedef __m128i simd_vec;
+const int SIMD_WIDTH = 4;
+
+inline simd_vec simd_load(const int * p) { return _mm_loadu_si128((const __m128i *) p); }
+inline void simd_store(int * p, simd_vec v) { _mm_storeu_si128((__m128i *) p, v); }
+inline simd_vec simd_min(simd_vec a, simd_vec b) { return _mm_min_epi32(a, b); }
+inline simd_vec simd_max(simd_vec a, simd_vec b) { return _mm_max_epi32(a, b); }
+inline simd_vec simd_lanes() { return _mm_setr_epi32(0, 1, 2, 3); }
+inline simd_vec simd_set1(int x) { return _mm_set1_epi32(x); }
+inline simd_vec simd_and(simd_vec a, simd_vec b) { return _mm_and_si128(a, b); }
+inline simd_vec simd_xor(simd_vec a, simd_vec b) { return _mm_xor_si128(a, b); }
+inline simd_vec simd_add(simd_vec a, simd_vec b) { return _mm_add_epi32(a, b); }
+inline simd_vec simd_is_zero(simd_vec a) { return _mm_cmpeq_epi32(a, _mm_setzero_si128()); }
+inline simd_vec simd_select(simd_vec a, simd_vec b, simd_vec mask) { return _mm_blendv_epi8(a, b, mask); }
+
+inline simd_vec simd_partner(simd_vec v, int j) {
+  return j == 1 ? _mm_shuffle_epi32(v, 0xB1) : _mm_shuffle_epi32(v, 0x4E);
+}
+
+inline simd_vec simd_reverse(simd_vec v) { return _mm_shuffle_epi32(v, 0x1B); }
+
+#endif
+
+
+#if defined(SORT_KERNELS_AVX2) || defined(SORT_KERNELS_SSE4)
+
+/* One compare-exchange stage of a bitonic network inside a register.
+   Lane i pairs with lane i ^ j; the pair is ascending when bit k of its
+   index in the block (base + i) is clear. The lane that takes the max is
+   the one with bit j set in an ascending pair, or clear in a descending
+   one. */
+inline simd_vec simd_exchange(simd_vec v, int j, int k, int base) {
+  simd_vec p = simd_partner(v, j);
+  simd_vec lanes = simd_lanes();
+  simd_vec low = simd_is_zero(simd_and(lanes, simd_set1(j)));
+  simd_vec asc = simd_is_zero(simd_and(simd_add(lanes, simd_set1(base)), simd_set1(k)));
+  return simd_select(simd_min(v, p), simd_max(v, p), simd_xor(low, asc));
+}
+
+
+template <int N>
+inline void sort_network(int * a) {
+  const int V = N / SIMD_WIDTH;
+  simd_vec r[V];
+
+  for (int v = 0; v < V; v++) r[v] = simd_load(a + v * SIMD_WIDTH);
+
+  for (int k = 2; k <= N; k *= 2) {
+    for (int j = k / 2; j > 0; j /= 2) {
+      if (j >= SIMD_WIDTH) {
+        // Pairs span two registers: vertical min/max.
+        int d = j / SIMD_WIDTH;
+        for (int v = 0; v < V; v++) {
+          if ((v * SIMD_WIDTH) & j) continue;
+          simd_vec lo = simd_min(r[v], r[v + d]);
+          simd_vec hi = simd_max(r[v], r[v + d]);
+          bool asc = ((v * SIMD_WIDTH) & k) == 0;
+          r[v] = asc ? lo : hi;
+          r[v + d] = asc ? hi : lo;
+        }
+      } else {
+        for (int v = 0; v < V; v++) {
+          r[v] = simd_exchange(r[v], j, k, v * SIMD_WIDTH);
+        }
+      }
+    }
+  }
+
+  for (int v = 0; v < V; v++) simd_store(a + v * SIMD_WIDTH, r[v]);
+}
+
+
+// Merges two sorted registers: lo gets the smallest W, hi the largest W.
+inline void simd_merge2(simd_vec & lo, simd_vec & hi) {
+  simd_vec b = simd_reverse(hi);
+  simd_vec l = simd_min(lo, b);
+  simd_vec h = simd_max(lo, b);
+
+  for (int j = SIMD_WIDTH / 2; j > 0; j /= 2) {
+    l = simd_exchange(l, j, 0, 0);
+    h = simd_exchange(h, j, 0, 0);
+  }
+  lo = l;
+  hi = h;
+}
+
+#else
+
+const int SIMD_WIDTH = 1;
+
+// Scalar fallback: the same bitonic network, one pair at a time.
+template <int N>
+inline void sort_network(int * a) {
+  for (int k = 2; k <= N; k *= 2) {
+    for (int j = k / 2; j > 0; j /= 2) {
+      for (int i = 0; i < N; i++) {
+        int p = i ^ j;
+        if (p <= i) continue;
+        int lo = std::min(a[i], a[p]);
+        int hi = std::max(a[i], a[p]);
+        bool asc = (i & k) == 0;
+        a[i] = asc ? lo : hi;
+        a[p] = asc ? hi : lo;
+      }
+    }
+  }
+}
+
+#endif
+
+
+// Sorts a[0..n) for n <= 32 by padding into the smallest network block.
+inline void small_sort(int * a, int n) {
+#if defined(SORT_KERNELS_AVX2) || defined(SORT_KERNELS_SSE4)
+  int block[32];
+
+  std::copy(a, a + n, block);
+  if (n <= 8) {
+    std::fill(block + n, block + 8, INT_MAX);
+    sort_network<8>(block);
+  } else if (n <= 16) {
+    std::fill(block + n, block + 16, INT_MAX);
+    sort_network<16>(block);
+  } else {
+    std::fill(block + n, block + 32, INT_MAX);
+    sort_network<32>(block);
+  }
+  std::copy(block, block + n, a);
+#else
+  // One pair at a time, the padded network does more work than insertion sort.
+  for (int i = 1; i < n; i++) {
+    int x = a[i];
+    int j = i - 1;
+    while (j >= 0 && a[j] > x) {
+      a[j + 1] = a[j];
+      j--;
+    }
+    a[j + 1] = x;
+  }
+#endif
+}
+
+
+// Scalar two-finger merge, ties to a.
+inline int * merge_scalar(const int * a, size_t na, const int * b, size_t nb, int * out) {
+  size_t i = 0, j = 0;
+
+  while (i < na && j < nb) {
+    bool take_b = b[j] < a[i];
+    *out++ = take_b ? b[j] : a[i];
+    j += take_b;
+    i += !take_b;
+  }
+  out = std::copy(a + i, a + na, out);
+  return std::copy(b + j, b + nb, out);
+}
+
+
+/* Merges sorted a[0..na) and b[0..nb) into out.
+   A register carries the W largest elements seen so far; the next block is
+   loaded from whichever input has the smaller head, merged with the
+   carried register, and the smaller half is stored. That is one branch per
+   W elements instead of one per element. */
+inline void merge_sorted(const int * a, size_t na, const int * b, size_t nb, int * out) {
+#if defined(SORT_KERNELS_AVX2) || defined(SORT_KERNELS_SSE4)
+  const size_t W = SIMD_WIDTH;
+
+  if (na < W || nb < W) {
+    merge_scalar(a, na, b, nb, out);
+    return;
+  }
+
+  simd_vec lo = simd_load(a);
+  simd_vec hi = simd_load(b);
+  size_t i = W, j = W;
+
+  simd_merge2(lo, hi);
+  simd_store(out, lo);
+  out += W;
+
+  while (i + W <= na && j + W <= nb) {
+    if (a[i] < b[j]) {
+      lo = simd_load(a + i);
+      i += W;
+    } else {
+      lo = simd_load(b + j);
+      j += W;
+    }
+    simd_merge2(lo, hi);
+    simd_store(out, lo);
+    out += W;
+  }
+
+  // The carried register is sorted and no smaller than anything stored;
+  // finish with it and both tails.
+  int carry[SIMD_WIDTH];
+  int tail[2 * SIMD_WIDTH];
+  simd_store(carry, hi);
+
+  if (i + W > na) {
+    int * end = merge_scalar(carry, W, a + i, na - i, tail);
+    merge_scalar(tail, end - tail, b + j, nb - j, out);
+  } else {
+    int * end = merge_scalar(carry, W, b + j, nb - j, tail);
+    merge_scalar(a + i, na - i, tail, end - tail, out);
+  }
+#else
+  merge_scalar(a, na, b, nb, out);
+#endif
+}
+
+#endif // SORT_KERNELS_H
@@ -0,0 +1,191 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+
+#include "sorts.h"
+#include "sortlib.h"
+#include "introsort.h"
+#include "parallel_msort.h"
+#include "radix_sort.h"
+#include "block_partition.h"
+#include "sample_sort.h"
+#include "argsort.h"
+#include "auto_sort.h"
+
+
+void print_vector(const std::vector<int> & vec) {
+  for (auto it : vec) {
+    std::cout << it << ", ";
+  }
+  std::cout << "\n";
+}
+
+
+std::vector<int> makeVec(int n, int max) {
+  std::vector<int> vec(n);
+
+  for (int i = 0; i < n; i++) {
+    vec.at(i) = rand() % max;
+  }
+  return vec;
+}
+
+
+// In-place quick sort.
+// Credit: https://www.geeksforgeeks.org/iterative-quick-sort/
+
+// Swaps made by swap(), for qsort2's count.
+static long long swap_calls = 0;
+
+void swap(int * a, int * b) {
+  swap_calls++;
+  int temp = * a;
+  * a = * b;
+  * b = temp;
+}
+
+
+/* This function takes last element as pivot,
+   places the pivot element at its correct
+   position in sorted  array, and places
+   all smaller (smaller than pivot) to left
+   of pivot and all greater elements to
+   right of pivot */
+
+int partition(std::vector<int> & arr, int l, int h) {
+  int x = arr[h];
+  int i = (l - 1);
+
+  for (int j = l; j <= h - 1; j++) {
+    if (arr[j] <= x) {
+      i++;
+      swap( & arr[i], & arr[j]);
+    }
+  }
+  swap( & arr[i + 1], & arr[h]);
+  return (i + 1);
+}
+
+
+/*
+A[] --> Array to be sorted,
+l --> Starting index,
+h --> Ending index
+*/
+
+void qsort2(std::vector<int> & A, int l, int h) {
+  if (l < h) {
+    /* Partitioning index */
+    int p = partition(A, l, h);
+    qsort2(A, l, p - 1);
+    qsort2(A, p + 1, h);
+  }
+}
+
+
+// Dispatch shared by the sorts CLI and the benchmark harness.
+// s, m and q are the class sorts, now done in place by sortlib.h.
+
+// What the last run_sort counted. The sortlib modes count through
+// counting_compare; qsort2 only through swap().
+static SortCounts counts;
+
+// What -a auto picked last time.
+static AutoChoice auto_choice;
+
+bool run_sort(char algorithm, std::vector<int> & a, int threads) {
+  sortlib::counting_compare<> counted{{}, &counts.comparisons, &counts.swaps};
+  counts = SortCounts();
+  if (algorithm == 's' || algorithm == 'm' || algorithm == 'q' || algorithm == 'T' ||
+      algorithm == 'I') {
+    counts.comparisons = 0;
+    counts.swaps = 0;
+  }
+
+  switch (algorithm) {
+  case 's':
+    sortlib::selection_sort(std::span<int>(a), counted);
+    break;
+  case 'm':
+    sortlib::merge_sort(std::span<int>(a), counted);
+    break;
+  case 'q':
+    sortlib::quick_sort(std::span<int>(a), counted);
+    break;
+  case 'r':
+    swap_calls = 0;
+    qsort2(a, 0, a.size()-1);
+    counts.swaps = swap_calls;
+    break;
+  case 'i':
+    introsort(a);
+    break;
+  case 'S':
+    std::sort(a.begin(), a.end());
+    break;
+  case 'M':
+    parallel_msort(a, threads);
+    break;
+  case 'R':
+    radix_sort(a);
+    break;
+  case 'b':
+    block_qsort(a);
+    break;
+  case 'P':
+    sample_sort(a, threads);
+    break;
+  case 'T':
+    sortlib::power_sort(std::span<int>(a), counted);
+    break;
+  case 'a':
+    auto_choice = auto_sort(a, threads);
+    break;
+  case 'I':
+    sortlib::inplace_merge_sort(std::span<int>(a), counted);
+    break;
+  case 'A': {
+    std::vector<uint32_t> perm;
+    std::vector<int> sorted;
+    argsort(a, perm);
+    gather(a, perm, sorted, threads);
+    a.swap(sorted);
+    break;
+  }
+  default:
+    return false;
+  }
+  return true;
+}
+
+
+const char * algorithm_name(char algorithm) {
+  switch (algorithm) {
+  case 's': return "selection";
+  case 'm': return "merge";
+  case 'q': return "quicksort";
+  case 'r': return "qsort2";
+  case 'i': return "introsort";
+  case 'S': return "std::sort";
+  case 'M': return "parallel merge";
+  case 'R': return "radix";
+  case 'b': return "block quicksort";
+  case 'P': return "sample sort";
+  case 'T': return "powersort";
+  case 'A': return "argsort+gather";
+  case 'I': return "in-place merge";
+  case 'a': return "auto";
+  }
+  return "unknown";
+}
+
+
+SortCounts last_counts() {
+  return counts;
+}
+
+
+std::string last_auto_choice() {
+  return auto_choice.engine + ": " + auto_choice.reason;
+}
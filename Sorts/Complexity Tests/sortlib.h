@@ -0,0 +1,609 @@
+#ifndef SORTLIB_H
+#define SORTLIB_H
+
+#include <vector>
+#include <span>
+#include <iterator>
+#include <functional>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+
+
+/* Generic in-place sorts over random-access iterators or std::span.
+   Elements are only ever moved or swapped, never copied, so move-only
+   types work, and nothing is passed or returned by value. Every sort takes
+   a strict-weak-order comparator (std::less<> by default).
+
+   - selection_sort: O(n^2), n - 1 swaps.
+   - insertion_sort: O(n^2), O(n) on sorted input.
+   - merge_sort:     O(n log n), stable, one buffer of n/2 elements.
+   - heap_sort:      O(n log n), no extra memory.
+   - quick_sort:     introsort, O(n log n) worst case, O(log n) stack.
+   - power_sort:     O(n log n), stable, adaptive: O(n) on presorted
+                     input and O(n H) in general, where H is the entropy
+                     of the natural run lengths. Buffer of n/2 at most.
+   - inplace_merge_sort: stable and adaptive like power_sort, with a
+                     fixed buffer of 512 elements. Merges of bigger runs
+                     are split by rotations, O(n log^2 n) worst case.
+
+   counting_compare wraps a comparator and counts its calls, which is how
+   the adaptivity of power_sort shows up next to merge_sort. Given a swaps
+   counter as well, the sorts add every element swap they make to it
+   (merges move elements rather than swap them, so they add none).
+   The int-only engines (introsort.h, block_partition.h, radix_sort.h) are
+   the tuned versions of these; this header is for everything else. */
+
+namespace sortlib {
+
+template <typename Compare = std::less<>>
+struct counting_compare {
+  Compare comp;
+  long long * count;
+  long long * swaps = nullptr;
+
+  template <typename A, typename B>
+  bool operator()(const A & a, const B & b) const {
+    ++*count;
+    return comp(a, b);
+  }
+};
+
+
+namespace detail {
+
+// Adds n swaps to comp's swap counter, if it has one.
+template <typename Compare>
+void count_swaps(Compare & comp, std::ptrdiff_t n) {
+  if constexpr (requires { comp.swaps; }) {
+    if (comp.swaps != nullptr) *comp.swaps += n;
+  }
+}
+
+template <typename It, typename Compare>
+void swap_elements(It a, It b, Compare & comp) {
+  std::iter_swap(a, b);
+  count_swaps(comp, 1);
+}
+
+} // namespace detail
+
+template <typename It, typename Compare = std::less<>>
+void selection_sort(It first, It last, Compare comp = Compare()) {
+  for (It i = first; i != last; ++i) {
+    It min = i;
+    for (It j = std::next(i); j != last; ++j) {
+      if (comp(*j, *min)) min = j;
+    }
+    if (min != i) detail::swap_elements(i, min, comp);
+  }
+}
+
+
+template <typename It, typename Compare = std::less<>>
+void insertion_sort(It first, It last, Compare comp = Compare()) {
+  if (first == last) return;
+
+  for (It i = std::next(first); i != last; ++i) {
+    auto x = std::move(*i);
+    It j = i;
+    while (j != first && comp(x, *std::prev(j))) {
+      *j = std::move(*std::prev(j));
+      --j;
+    }
+    *j = std::move(x);
+  }
+}
+
+
+namespace detail {
+
+const std::ptrdiff_t MERGE_INSERTION_CUTOFF = 24;
+const std::ptrdiff_t QUICK_INSERTION_CUTOFF = 24;
+
+
+// Sorts [first, last), moving the left half into buf for each merge.
+template <typename It, typename T, typename Compare>
+void merge_sort_rec(It first, It last, std::vector<T> & buf, Compare & comp) {
+  std::ptrdiff_t n = last - first;
+  if (n <= MERGE_INSERTION_CUTOFF) {
+    insertion_sort(first, last, comp);
+    return;
+  }
+
+  It mid = first + n / 2;
+  merge_sort_rec(first, mid, buf, comp);
+  merge_sort_rec(mid, last, buf, comp);
+
+  // Already in order: nothing to merge.
+  if (!comp(*mid, *std::prev(mid))) return;
+
+  buf.clear();
+  buf.insert(buf.end(), std::make_move_iterator(first), std::make_move_iterator(mid));
+
+  auto l = buf.begin();
+  It r = mid, out = first;
+  while (l != buf.end() && r != last) {
+    if (comp(*r, *l)) {
+      *out = std::move(*r);
+      ++r;
+    } else {
+      *out = std::move(*l);
+      ++l;
+    }
+    ++out;
+  }
+  std::move(l, buf.end(), out);
+}
+
+
+template <typename It, typename Compare>
+void sift_down(It first, std::ptrdiff_t root, std::ptrdiff_t n, Compare & comp) {
+  auto x = std::move(first[root]);
+
+  while (2 * root + 1 < n) {
+    std::ptrdiff_t child = 2 * root + 1;
+    if (child + 1 < n && comp(first[child], first[child + 1])) child++;
+    if (!comp(x, first[child])) break;
+
+    first[root] = std::move(first[child]);
+    root = child;
+  }
+  first[root] = std::move(x);
+}
+
+
+template <typename It, typename Compare>
+void sort3(It a, It b, It c, Compare & comp) {
+  if (comp(*b, *a)) swap_elements(a, b, comp);
+  if (comp(*c, *b)) swap_elements(b, c, comp);
+  if (comp(*b, *a)) swap_elements(a, b, comp);
+}
+
+
+// Hoare partition around a median-of-three pivot moved to *first.
+template <typename It, typename Compare>
+It hoare_partition(It first, It last, Compare & comp) {
+  It mid = first + (last - first) / 2;
+  sort3(first, mid, std::prev(last), comp);
+  swap_elements(first, mid, comp);
+
+  It i = first, j = last;
+  while (true) {
+    while (comp(*++i, *first)) {
+      if (i == std::prev(last)) break;
+    }
+    while (comp(*first, *--j)) {
+    }
+    if (i >= j) break;
+    swap_elements(i, j, comp);
+  }
+  swap_elements(first, j, comp);
+  return j;
+}
+
+
+template <typename It, typename Compare>
+void quick_sort_loop(It first, It last, int depth, Compare & comp);
+
+
+/* Powersort (Munro and Wild) helpers. */
+
+const std::ptrdiff_t POWER_MIN_RUN = 24;
+const int POWER_MIN_GALLOP = 7;
+const std::ptrdiff_t INPLACE_MERGE_BUFFER = 512;
+
+
+// Sorts [first, last) given that [first, sorted) is already sorted, with a
+// binary search per element. Ties go after their equals, so it is stable.
+template <typename It, typename Compare>
+void binary_insertion_sort(It first, It sorted, It last, Compare & comp) {
+  for (It i = sorted; i != last; ++i) {
+    It pos = std::upper_bound(first, i, *i, comp);
+    if (pos == i) continue;
+
+    auto x = std::move(*i);
+    std::move_backward(pos, i, std::next(i));
+    *pos = std::move(x);
+  }
+}
+
+
+// Length of the natural run at first: non-descending, or strictly
+// descending and then reversed (strict, so equal keys keep their order).
+// Short runs are extended to POWER_MIN_RUN with binary insertion.
+template <typename It, typename Compare>
+std::ptrdiff_t next_run(It first, It last, Compare & comp) {
+  std::ptrdiff_t rest = last - first;
+  if (rest < 2) return rest;
+
+  It end = std::next(first, 2);
+  if (comp(first[1], first[0])) {
+    while (end != last && comp(*end, *std::prev(end))) ++end;
+    std::reverse(first, end);
+    count_swaps(comp, (end - first) / 2);
+  } else {
+    while (end != last && !comp(*end, *std::prev(end))) ++end;
+  }
+
+  std::ptrdiff_t len = end - first;
+  if (len < POWER_MIN_RUN) {
+    std::ptrdiff_t target = std::min(POWER_MIN_RUN, rest);
+    binary_insertion_sort(first, end, first + target, comp);
+    len = target;
+  }
+  return len;
+}
+
+
+// Depth of the boundary between runs [s1, s1 + n1) and [s1 + n1, s1 + n1 + n2)
+// in the perfectly balanced merge tree over [0, n): the first bit where the
+// two run midpoints, as fractions of n, differ.
+inline int node_power(std::ptrdiff_t n, std::ptrdiff_t s1, std::ptrdiff_t n1, std::ptrdiff_t n2) {
+  uint64_t a = 2 * s1 + n1;             // twice the midpoints
+  uint64_t b = 2 * s1 + 2 * n1 + n2;
+  int power = 0;
+
+  while (true) {
+    power++;
+    bool bit_a = a >= static_cast<uint64_t>(n);
+    bool bit_b = b >= static_cast<uint64_t>(n);
+    if (bit_a != bit_b) return power;
+    if (bit_a) {
+      a -= n;
+      b -= n;
+    }
+    a *= 2;
+    b *= 2;
+  }
+}
+
+
+// First position in [first, last) whose key is > key (upper bound) or
+// >= key (lower bound), found by doubling steps from first and then a
+// binary search: O(log d) for an answer d positions in.
+template <typename It, typename T, typename Compare>
+It gallop_upper(It first, It last, const T & key, Compare & comp) {
+  std::ptrdiff_t n = last - first, bound = 1;
+  while (bound <= n && !comp(key, first[bound - 1])) bound *= 2;
+  return std::upper_bound(first + bound / 2, first + std::min(bound, n), key, comp);
+}
+
+template <typename It, typename T, typename Compare>
+It gallop_lower(It first, It last, const T & key, Compare & comp) {
+  std::ptrdiff_t n = last - first, bound = 1;
+  while (bound <= n && comp(first[bound - 1], key)) bound *= 2;
+  return std::lower_bound(first + bound / 2, first + std::min(bound, n), key, comp);
+}
+
+
+/* TimSort's merge of a buffered left run [b, be) with a right run [r, last),
+   writing from out = the start of the left run. It takes one element at a
+   time until one side wins POWER_MIN_GALLOP times in a row, then gallops:
+   it searches for where the other side's head goes and moves the whole
+   block at once. min_gallop adapts, falling while galloping pays off and
+   rising when it doesn't. Ties go to the left run. */
+template <typename BufIt, typename It, typename Compare>
+void gallop_merge(BufIt b, BufIt be, It r, It last, It out, Compare & comp, int & min_gallop) {
+  while (b != be && r != last) {
+    int wins_b = 0, wins_r = 0;
+
+    while (true) {
+      if (comp(*r, *b)) {
+        *out = std::move(*r);
+        ++out;
+        wins_b = 0;
+        if (++r == last || ++wins_r >= min_gallop) break;
+      } else {
+        *out = std::move(*b);
+        ++out;
+        wins_r = 0;
+        if (++b == be || ++wins_b >= min_gallop) break;
+      }
+    }
+    if (b == be || r == last) break;
+
+    while (true) {
+      BufIt k = gallop_upper(b, be, *r, comp);
+      wins_b = k - b;
+      out = std::move(b, k, out);
+      b = k;
+      if (b == be) break;
+
+      *out = std::move(*r);
+      ++out;
+      ++r;
+      if (r == last) break;
+
+      It j = gallop_lower(r, last, *b, comp);
+      wins_r = j - r;
+      out = std::move(r, j, out);
+      r = j;
+      if (r == last) break;
+
+      *out = std::move(*b);
+      ++out;
+      ++b;
+
+      if (min_gallop > 1) min_gallop--;
+      if (wins_b < POWER_MIN_GALLOP && wins_r < POWER_MIN_GALLOP) break;
+    }
+    min_gallop += 2;
+  }
+  // What is left of the right run is already in place.
+  std::move(b, be, out);
+}
+
+
+// Stable merge of adjacent sorted runs [first, mid) and [mid, last),
+// buffering only the smaller one after trimming what is already in place.
+template <typename It, typename T, typename Compare>
+void power_merge(It first, It mid, It last, std::vector<T> & buf, Compare & comp, int & min_gallop) {
+  // Left keys <= the right run's head and right keys >= the left run's
+  // tail don't move.
+  first = gallop_upper(first, mid, *mid, comp);
+  if (first == mid) return;
+  last = gallop_lower(mid, last, *std::prev(mid), comp);
+
+  buf.clear();
+  if (mid - first <= last - mid) {
+    buf.insert(buf.end(), std::make_move_iterator(first), std::make_move_iterator(mid));
+    gallop_merge(buf.begin(), buf.end(), mid, last, first, comp, min_gallop);
+  } else {
+    // Backwards: the same merge on reversed ranges with the order flipped,
+    // so ties still keep the left run first.
+    buf.insert(buf.end(), std::make_move_iterator(mid), std::make_move_iterator(last));
+    auto flipped = [&comp](const auto & x, const auto & y) { return comp(y, x); };
+    gallop_merge(buf.rbegin(), buf.rend(), std::make_reverse_iterator(mid),
+                 std::make_reverse_iterator(first), std::make_reverse_iterator(last),
+                 flipped, min_gallop);
+  }
+}
+
+} // namespace detail
+
+
+template <typename It, typename Compare = std::less<>>
+void heap_sort(It first, It last, Compare comp = Compare()) {
+  std::ptrdiff_t n = last - first;
+
+  for (std::ptrdiff_t i = n / 2 - 1; i >= 0; i--) {
+    detail::sift_down(first, i, n, comp);
+  }
+  for (std::ptrdiff_t end = n - 1; end > 0; end--) {
+    detail::swap_elements(first, first + end, comp);
+    detail::sift_down(first, 0, end, comp);
+  }
+}
+
+
+template <typename It, typename Compare = std::less<>>
+void merge_sort(It first, It last, Compare comp = Compare()) {
+  typedef typename std::iterator_traits<It>::value_type T;
+
+  std::vector<T> buf;
+  buf.reserve((last - first) / 2 + 1);
+  detail::merge_sort_rec(first, last, buf, comp);
+}
+
+
+template <typename It, typename Compare = std::less<>>
+void quick_sort(It first, It last, Compare comp = Compare()) {
+  int depth = 0;
+  for (std::ptrdiff_t k = last - first; k > 1; k >>= 1) {
+    depth += 2;
+  }
+  detail::quick_sort_loop(first, last, depth, comp);
+}
+
+
+namespace detail {
+
+/* Powersort's run loop: one pass finds the natural runs, and each new
+   boundary gets a power, its depth in the ideal balanced merge tree. Runs
+   on the stack above a boundary of greater power are merged before it is
+   pushed, so the merges follow a nearly optimal tree. merge(a, b, c)
+   merges the adjacent runs [a, b) and [b, c). */
+template <typename It, typename Compare, typename Merge>
+void power_sort_loop(It first, It last, Compare & comp, Merge merge) {
+  std::ptrdiff_t n = last - first;
+  if (n < 2) return;
+
+  struct Run {
+    It begin;
+    std::ptrdiff_t len;
+    int power;
+  };
+  std::vector<Run> stack;
+
+  It begin = first;
+  std::ptrdiff_t len = next_run(first, last, comp);
+
+  while (begin + len != last) {
+    It next = begin + len;
+    std::ptrdiff_t next_len = next_run(next, last, comp);
+    int power = node_power(n, begin - first, len, next_len);
+
+    while (!stack.empty() && stack.back().power > power) {
+      Run top = stack.back();
+      stack.pop_back();
+      merge(top.begin, begin, begin + len);
+      begin = top.begin;
+      len += top.len;
+    }
+    stack.push_back({begin, len, power});
+    begin = next;
+    len = next_len;
+  }
+
+  while (!stack.empty()) {
+    Run top = stack.back();
+    stack.pop_back();
+    merge(top.begin, begin, begin + len);
+    begin = top.begin;
+    len += top.len;
+  }
+}
+
+
+// Rotates [first, last) so that middle comes first, and returns where
+// first's element ends up. Through buf when the shorter side fits in its
+// capacity, otherwise std::rotate.
+template <typename It, typename T>
+It rotate_buffered(It first, It middle, It last, std::vector<T> & buf) {
+  std::ptrdiff_t len1 = middle - first, len2 = last - middle;
+  std::ptrdiff_t cap = buf.capacity();
+
+  buf.clear();
+  if (len1 <= len2 && len1 <= cap) {
+    buf.insert(buf.end(), std::make_move_iterator(first), std::make_move_iterator(middle));
+    It out = std::move(middle, last, first);
+    std::move(buf.begin(), buf.end(), out);
+    return out;
+  }
+  if (len2 <= cap) {
+    buf.insert(buf.end(), std::make_move_iterator(middle), std::make_move_iterator(last));
+    std::move_backward(first, middle, last);
+    return std::move(buf.begin(), buf.end(), first);
+  }
+  return std::rotate(first, middle, last);
+}
+
+
+/* Stable merge of [first, mid) and [mid, last) that never grows buf. Once
+   one run fits in buf's capacity it is a power_merge. Until then the
+   longer run is cut in half, the other at the matching key (lower bound
+   on the right, upper bound on the left, which keeps ties in order), and
+   the two middle pieces are rotated past each other. That leaves two
+   independent, smaller merges. */
+template <typename It, typename T, typename Compare>
+void bounded_merge(It first, It mid, It last, std::vector<T> & buf, Compare & comp, int & min_gallop) {
+  std::ptrdiff_t cap = buf.capacity();
+
+  while (first != mid && mid != last) {
+    std::ptrdiff_t len1 = mid - first, len2 = last - mid;
+    if (std::min(len1, len2) <= cap) {
+      power_merge(first, mid, last, buf, comp, min_gallop);
+      return;
+    }
+
+    It cut1, cut2;
+    if (len1 >= len2) {
+      cut1 = first + len1 / 2;
+      cut2 = std::lower_bound(mid, last, *cut1, comp);
+    } else {
+      cut2 = mid + len2 / 2;
+      cut1 = std::upper_bound(first, mid, *cut2, comp);
+    }
+    It new_mid = rotate_buffered(cut1, mid, cut2, buf);
+
+    // Recurse on the smaller merge, loop on the larger.
+    if (new_mid - first < last - new_mid) {
+      bounded_merge(first, cut1, new_mid, buf, comp, min_gallop);
+      first = new_mid;
+      mid = cut2;
+    } else {
+      bounded_merge(new_mid, cut2, last, buf, comp, min_gallop);
+      last = new_mid;
+      mid = cut1;
+    }
+  }
+}
+
+} // namespace detail
+
+
+// Powersort: merges through a buffer that grows to the smaller run.
+template <typename It, typename Compare = std::less<>>
+void power_sort(It first, It last, Compare comp = Compare()) {
+  typedef typename std::iterator_traits<It>::value_type T;
+
+  std::vector<T> buf;
+  int min_gallop = detail::POWER_MIN_GALLOP;
+  detail::power_sort_loop(first, last, comp, [&](It a, It b, It c) {
+    detail::power_merge(a, b, c, buf, comp, min_gallop);
+  });
+}
+
+
+// Powersort with a buffer of INPLACE_MERGE_BUFFER elements, whatever n is.
+template <typename It, typename Compare = std::less<>>
+void inplace_merge_sort(It first, It last, Compare comp = Compare()) {
+  typedef typename std::iterator_traits<It>::value_type T;
+
+  std::vector<T> buf;
+  buf.reserve(detail::INPLACE_MERGE_BUFFER);
+  int min_gallop = detail::POWER_MIN_GALLOP;
+  detail::power_sort_loop(first, last, comp, [&](It a, It b, It c) {
+    detail::bounded_merge(a, b, c, buf, comp, min_gallop);
+  });
+}
+
+
+namespace detail {
+
+// Recurse on the smaller side, loop on the larger; heapsort past depth.
+template <typename It, typename Compare>
+void quick_sort_loop(It first, It last, int depth, Compare & comp) {
+  while (last - first > QUICK_INSERTION_CUTOFF) {
+    if (depth == 0) {
+      heap_sort(first, last, comp);
+      return;
+    }
+    depth--;
+
+    It p = hoare_partition(first, last, comp);
+    if (p - first < last - p) {
+      quick_sort_loop(first, p, depth, comp);
+      first = std::next(p);
+    } else {
+      quick_sort_loop(std::next(p), last, depth, comp);
+      last = p;
+    }
+  }
+  insertion_sort(first, last, comp);
+}
+
+} // namespace detail
+
+
+// std::span overloads.
+
+template <typename T, typename Compare = std::less<>>
+void selection_sort(std::span<T> s, Compare comp = Compare()) {
+  selection_sort(s.begin(), s.end(), comp);
+}
+
+template <typename T, typename Compare = std::less<>>
+void insertion_sort(std::span<T> s, Compare comp = Compare()) {
+  insertion_sort(s.begin(), s.end(), comp);
+}
+
+template <typename T, typename Compare = std::less<>>
+void merge_sort(std::span<T> s, Compare comp = Compare()) {
+  merge_sort(s.begin(), s.end(), comp);
+}
+
+template <typename T, typename Compare = std::less<>>
+void heap_sort(std::span<T> s, Compare comp = Compare()) {
+  heap_sort(s.begin(), s.end(), comp);
+}
+
+template <typename T, typename Compare = std::less<>>
+void quick_sort(std::span<T> s, Compare comp = Compare()) {
+  quick_sort(s.begin(), s.end(), comp);
+}
+
+template <typename T, typename Compare = std::less<>>
+void power_sort(std::span<T> s, Compare comp = Compare()) {
+  power_sort(s.begin(), s.end(), comp);
+}
+
+template <typename T, typename Compare = std::less<>>
+void inplace_merge_sort(std::span<T> s, Compare comp = Compare()) {
+  inplace_merge_sort(s.begin(), s.end(), comp);
+}
+
+} // namespace sortlib
+
+#endif // SORTLIB_H
@@ -1,210 +1,250 @@
 #include <iostream>
+#include <fstream>
 #include <vector>
+#include <string>
 #include <time.h>
-#include <unistd.h>
+#include <getopt.h>
 #include <cstdlib>
-#include <sys/time.h>
-#include <math.h>
+#include <climits>
+#include <chrono>
+#include <thread>
+#include <memory>
 
+#include "sorts.h"
+#include "datagen.h"
+#include "external_sort.h"
+#include "select.h"
+#include "perf_counters.h"
 
-void print_vector(std::vector<int> vec) {
-  for (auto it : vec) {
-    std::cout << it << ", ";
-  }
-  std::cout << "\n";
-}
 
+// Arugment passing + Main
 
-int find_min(std::vector<int> vec, int begin) {
-  int min = begin;
-  for (int i = begin; i < vec.size(); i++) {
-    if (vec[i] < vec[min]) {
-      min = i;
-    }
-  }
-  return min;
+void print_help(char * command_name) {
+  std::cout << "Usage: " << command_name;
+  std::cout << " [-h|-p|-m N|-s N|-t N|-r N|-d distribution|-a algorithm]\n\n";
+  std::cout << " -m MAX_ELEMENT_SIZE\n";
+  std::cout << " -s DATA_SET_SIZE\n";
+  std::cout << " -t THREADS (parallel modes, default: all cores)\n";
+  std::cout << " -r SEED (default: time of day)\n";
+  std::cout << " -d uniform|sorted|reverse|nearly|fewunique|organpipe|zipf|sawtooth\n";
+  std::cout << " -a[s|m]: s - selection, m - merge, q - quicksort, r - qsort2 (iterative)\n";
+  std::cout << "          i - introsort, b - block quicksort, S - std::sort, M - parallel merge\n";
+  std::cout << "          R - radix (counting sort when MAX_ELEMENT_SIZE <= DATA_SET_SIZE)\n";
+  std::cout << "          P - parallel sample sort, T - powersort (stable, adaptive)\n";
+  std::cout << "          A - argsort, then gather the keys by the permutation\n";
+  std::cout << "          I - in-place merge (stable, 512-element buffer)\n";
+  std::cout << "          auto (or a) - pick counting, radix, powersort, sample sort or\n";
+  std::cout << "          introsort from a sample of the input, and say why\n";
+  std::cout << "\nExternal sort of a raw file of ints:\n";
+  std::cout << " -f INPUT -o OUTPUT [--mem BYTES] [--direct]\n";
+  std::cout << " --mem BYTES     memory budget, e.g. 512M or 4G (default: 1G)\n";
+  std::cout << " --direct        O_DIRECT I/O where the file system allows it\n";
+  std::cout << " -g FILE         write the generated data set to FILE instead of sorting it\n";
+  std::cout << "\nSelection, each timed against a full sort with -a followed by indexing:\n";
+  std::cout << " --select K      K-th smallest key (0-based)\n";
+  std::cout << " --percentiles P1,P2,...  nearest-rank percentiles, e.g. 50,90,99\n";
+  std::cout << " --topk K        K largest keys, streamed through a bounded heap\n";
+  std::cout << "\n --counters      report hardware counters (perf_event_open), swaps,\n";
+  std::cout << "                 allocations and peak RSS growth for the sort\n";
 }
 
 
-std::vector<int> ssort(std::vector<int> vec) {
-  for (int i = 0; i < vec.size(); i++) {
-    int min, tmp;
-    min = find_min(vec, i);
-
-    tmp = vec[i];
-    vec[i] = vec[min];
-    vec[min] = tmp;
-  }
-  return vec;
-}
-
+struct Queries {
+  long select_k = -1;
+  std::vector<double> percentiles;
+  int topk = 0;
 
-std::vector<int> merge(std::vector<int> left, std::vector<int> right) {
-  std::vector<int> merged;
-  int l = 0, r = 0;
+  bool any() const { return select_k >= 0 || !percentiles.empty() || topk > 0; }
+};
 
-  while (l < left.size() && r < right.size()) {
-    if (left[l] < right[r]) {
-      merged.push_back(left[l]);
-      l++;
-    } else {
-      merged.push_back(right[r]);
-      r++;
-    }
-  }
 
-  while (l < left.size()) {
-    merged.push_back(left[l]);
-    l++;
+// A whole non-negative count; false on "x", "3x" or "-3".
+bool parse_count(const std::string & s, long & n) {
+  size_t used = 0;
+  try {
+    n = std::stol(s, &used);
+  } catch (const std::exception &) {
+    return false;
   }
-  while (r < right.size()) {
-    merged.push_back(right[r]);
-    r++;
-  }
-
-  return merged;
+  return used == s.size() && n >= 0;
 }
 
 
-// found error with last merge, fixed.
-// Was previously slower than quick sort despite being later on.
-std::vector<int> msort(std::vector<int> v) {
-  if (v.size() < 2) return v;
-
-  int s = v.size();
-  std::vector<int> left, right;
-
-  for (int i = 0; i < s; i++) {
-    if (i < s / 2) {
-      left.push_back(v[i]);
-    } else {
-      right.push_back(v[i]);
+// Each field must be a number in [0, 100]; "50," or "x" are rejected.
+bool parse_percentiles(const std::string & spec, std::vector<double> & ps) {
+  ps.clear();
+  size_t start = 0;
+  while (start <= spec.size()) {
+    size_t comma = spec.find(',', start);
+    if (comma == std::string::npos) comma = spec.size();
+    std::string field = spec.substr(start, comma - start);
+    size_t used = 0;
+    double p;
+    try {
+      p = std::stod(field, &used);
+    } catch (const std::exception &) {
+      return false;
     }
+    if (used != field.size() || !(p >= 0 && p <= 100)) return false;
+    ps.push_back(p);
+    start = comma + 1;
   }
-  left = msort(left);
-  right = msort(right);
-
-  return merge(left, right);
+  return true;
 }
 
 
-std::vector<int> makeVec(int n, int max) {
-  std::vector<int> vec(n);
-
-  for (int i = 0; i < n; i++) {
-    vec.at(i) = rand() % max;
-  }
-  return vec;
+double ms_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
 }
 
 
-// qsort from class.
-std::vector<int>qsort(std::vector<int> list) {
-  int i, j;
-
-  if (list.size() <= 1) return list; // base case
+void print_keys(const std::vector<int> & keys) {
+  for (size_t i = 0; i < keys.size(); i++) {
+    std::cout << (i ? ", " : "") << keys[i];
+  }
+}
 
-  int pivot = list[0]; // using index 0 as piviot for general testing.
 
-  std::vector<int> lower, upper;
+// Answers each query by selection, then again from a full sort of a copy,
+// and checks that both agree.
+int run_queries(const std::vector<int> & a, char algorithm, int threads, const Queries & q) {
+  std::vector<int> sorted = a;
+  auto start = std::chrono::steady_clock::now();
+  if (!run_sort(algorithm, sorted, threads)) {
+    std::cout << "Unknown algorithm " << algorithm << "\n";
+    return 1;
+  }
+  double sort_ms = ms_since(start);
+  bool agree = true;
 
-  // min max.
-  for (i = 1; i < list.size(); i++) {
-    if (list[i] < pivot) {
-      lower.push_back(list[i]);
-    } else {
-      upper.push_back(list[i]);
+  if (q.select_k >= 0) {
+    if (q.select_k >= static_cast<long>(a.size())) {
+      std::cerr << "ERROR: --select " << q.select_k << " is out of range\n";
+      return 1;
     }
+    std::vector<int> b = a;
+    start = std::chrono::steady_clock::now();
+    int value = select_kth(b, q.select_k);
+    double ms = ms_since(start);
+
+    agree &= value == sorted[q.select_k];
+    std::cout << "Select " << q.select_k << ": " << value << "\n";
+    std::cout << "  introselect: " << ms << " ms, full sort + index: " << sort_ms << " ms\n";
   }
-  // recursive calls to sort vector.
-  lower = qsort(lower);
-  upper = qsort(upper);
-
-  // shoving new values of lower & upper into list.
-  for (i = 0; i < lower.size(); i++)
-    list[i] = lower[i];
 
-  list[i] = pivot;
-  i++;
+  if (!q.percentiles.empty() && !a.empty()) {
+    std::vector<int> b = a;
+    start = std::chrono::steady_clock::now();
+    std::vector<int> values = percentiles(b, q.percentiles);
+    double ms = ms_since(start);
 
-  for (j = 0; j < upper.size(); j++) {
-    list[i] = upper[j];
-    i++;
+    std::vector<int> expected;
+    for (double p : q.percentiles) {
+      expected.push_back(sorted[percentile_rank(p, a.size())]);
+    }
+    agree &= values == expected;
+    std::cout << "Percentiles: ";
+    print_keys(values);
+    std::cout << "\n  multiselect: " << ms << " ms, full sort + index: " << sort_ms << " ms\n";
   }
-  return list;
-}
-
 
-// In-place quick sort.
-// Credit: https://www.geeksforgeeks.org/iterative-quick-sort/
+  if (q.topk > 0) {
+    start = std::chrono::steady_clock::now();
+    TopK top(q.topk);
+    for (int x : a) {
+      top.push(x);
+    }
+    std::vector<int> values = top.result();
+    double ms = ms_since(start);
+
+    std::vector<int> expected(sorted.rbegin(), sorted.rbegin() + std::min<size_t>(q.topk, sorted.size()));
+    agree &= values == expected;
+    std::cout << "Top " << q.topk << ": ";
+    print_keys(values);
+    std::cout << "\n  bounded heap: " << ms << " ms, full sort + index: " << sort_ms << " ms\n";
+  }
 
-void swap(int * a, int * b) {
-  int temp = * a;
-  * a = * b;
-  * b = temp;
+  if (!agree) {
+    std::cerr << "ERROR: selection and full sort disagree\n";
+    return 1;
+  }
+  return 0;
 }
 
 
-/* This function takes last element as pivot,
-   places the pivot element at its correct
-   position in sorted  array, and places
-   all smaller (smaller than pivot) to left
-   of pivot and all greater elements to
-   right of pivot */
-
-int partition(std::vector<int> & arr, int l, int h) {
-  int x = arr[h];
-  int i = (l - 1);
-
-  for (int j = l; j <= h - 1; j++) {
-    if (arr[j] <= x) {
-      i++;
-      swap( & arr[i], & arr[j]);
+// Counts for one sort: what the mode counted itself, the allocations made
+// during it, and the perf events that could be opened.
+void print_counters(long n, const AllocStats & before, const AllocStats & after, long long rss_growth,
+                    const PerfSample & perf) {
+  SortCounts counts = last_counts();
+  if (counts.swaps >= 0) std::cout << "Swaps: " << counts.swaps << "\n";
+  std::cout << "Allocated: " << after.bytes - before.bytes << " bytes in " << after.calls - before.calls
+            << " allocations, peak " << after.peak - before.live << " bytes\n";
+  if (rss_growth >= 0) std::cout << "Peak RSS growth: " << rss_growth << " bytes\n";
+
+  for (int e = 0; e < PERF_EVENTS; e++) {
+    std::cout << perf_event_name(e) << ": ";
+    if (perf.value[e] < 0) {
+      std::cout << "n/a\n";
+      continue;
     }
+    std::cout << perf.value[e];
+    if (n > 0) std::cout << " (" << static_cast<double>(perf.value[e]) / n << " per element)";
+    std::cout << "\n";
   }
-  swap( & arr[i + 1], & arr[h]);
-  return (i + 1);
-}
-
-
-/*
-A[] --> Array to be sorted,
-l --> Starting index,
-h --> Ending index
-*/
-
-void qsort2(std::vector<int> & A, int l, int h) {
-  if (l < h) {
-    /* Partitioning index */
-    int p = partition(A, l, h);
-    qsort2(A, l, p - 1);
-    qsort2(A, p + 1, h);
+  if (perf.value[PERF_CYCLES] > 0 && perf.value[PERF_INSTRUCTIONS] >= 0) {
+    std::cout << "IPC: " << static_cast<double>(perf.value[PERF_INSTRUCTIONS]) / perf.value[PERF_CYCLES] << "\n";
   }
 }
 
 
-// Arugment passing + Main
+// External sort mode: sorts a file that need not fit in memory.
+int sort_file(const std::string & input, const std::string & output, const ExternalSortOptions & options) {
+  ExternalSortStats stats;
 
-void print_help(char * command_name) {
-  std::cout << "Usage: " << command_name;
-  std::cout << " [-h|-p|-m N|-s N|-a algorithm]\n\n";
-  std::cout << " -m MAX_ELEMENT_SIZE\n";
-  std::cout << " -s DATA_SET_SIZE\n";
-  std::cout << " -a[s|m]: s - selection, m - merge, q - qsort, r - qsort2 (iterative)\n";
-}
+  std::cout << "Starting the external sort!\n";
+  if (!external_sort(input, output, options, stats)) return 1;
 
+  double total_ms = stats.run_ms + stats.merge_ms;
+  std::cout << "Elements: " << stats.elements << "\n";
+  std::cout << "Runs: " << stats.runs << "\n";
+  std::cout << "Run formation: " << stats.run_ms << " ms\n";
+  std::cout << "Merge: " << stats.merge_ms << " ms\n";
+  std::cout << "Time: " << total_ms << " ms\n";
+  if (total_ms > 0) {
+    // Input MB/s; every byte goes through the disk twice each way.
+    std::cout << "Throughput: " << stats.elements * sizeof(int) / (total_ms * 1e3) << " MB/s\n";
+  }
+  return 0;
+}
 
-extern char * optarg;
 
 int main(int argc, char * argv[]) {
 
-  int size = 20;
+  long size = 20;
   int max_val = 100;
   char algorithm = 's' ;
+  int threads = std::thread::hardware_concurrency();
+  unsigned seed = time(nullptr);
+  Distribution dist = UNIFORM;
   bool print = false;
-  char c;
-
-  while ((c = getopt(argc, argv, "phs:m:a:")) != -1) {
+  std::string input_path, output_path, generate_path;
+  ExternalSortOptions ext;
+  Queries queries;
+  bool counters = false;
+  int c;
+
+  static struct option long_options[] = {
+    {"mem", required_argument, nullptr, 'M'},
+    {"direct", no_argument, nullptr, 'D'},
+    {"select", required_argument, nullptr, 'K'},
+    {"percentiles", required_argument, nullptr, 'P'},
+    {"topk", required_argument, nullptr, 'k'},
+    {"counters", no_argument, nullptr, 'C'},
+    {nullptr, 0, nullptr, 0}
+  };
+
+  while ((c = getopt_long(argc, argv, "phs:m:a:t:r:d:f:o:g:", long_options, nullptr)) != -1) {
 
     switch (c) {
     case 'h' :
@@ -215,22 +255,111 @@ int main(int argc, char * argv[]) {
       print = true;
       break;
     case 's' :
-      size = std::stoi(optarg);
+      size = static_cast<long>(std::stod(optarg));
       break;
     case 'm' :
       max_val = std::stoi(optarg);
       break;
+    case 't' :
+      threads = std::stoi(optarg);
+      break;
+    case 'r' :
+      seed = std::stoul(optarg);
+      break;
+    case 'd' :
+      if (!parse_distribution(optarg, dist)) {
+        print_help(argv[0]);
+        exit(1);
+      }
+      break;
     case 'a':
-      algorithm = optarg[0];
+      // One mode letter, or "auto"; anything longer used to be cut to
+      // its first letter without a word.
+      if (std::string(optarg) == "auto") {
+        algorithm = 'a';
+      } else if (optarg[0] != '\0' && optarg[1] == '\0') {
+        algorithm = optarg[0];
+      } else {
+        std::cerr << "Unknown algorithm " << optarg << "\n";
+        print_help(argv[0]);
+        exit(1);
+      }
+      break;
+    case 'f' :
+      input_path = optarg;
+      break;
+    case 'o' :
+      output_path = optarg;
+      break;
+    case 'g' :
+      generate_path = optarg;
+      break;
+    case 'M' :
+      if (!parse_memory_size(optarg, ext.memory_bytes)) {
+        print_help(argv[0]);
+        exit(1);
+      }
+      break;
+    case 'D' :
+      ext.direct_io = true;
+      break;
+    case 'K' :
+      if (!parse_count(optarg, queries.select_k)) {
+        std::cerr << "Bad --select " << optarg << "\n";
+        print_help(argv[0]);
+        exit(1);
+      }
+      break;
+    case 'P' :
+      if (!parse_percentiles(optarg, queries.percentiles)) {
+        std::cerr << "Bad --percentiles " << optarg << "\n";
+        print_help(argv[0]);
+        exit(1);
+      }
+      break;
+    case 'k' : {
+      long k;
+      if (!parse_count(optarg, k) || k < 1 || k > INT_MAX) {
+        std::cerr << "Bad --topk " << optarg << "\n";
+        print_help(argv[0]);
+        exit(1);
+      }
+      queries.topk = static_cast<int>(k);
+      break;
+    }
+    case 'C' :
+      counters = true;
+      break;
+    default :
+      print_help(argv[0]);
+      exit(1);
+    }
+  }
+
+  if (!input_path.empty()) {
+    if (output_path.empty()) {
+      print_help(argv[0]);
+      exit(1);
     }
+    return sort_file(input_path, output_path, ext);
   }
 
 
-  srand(time(nullptr));
-  std::vector<int> a(size);
-  int i;
-  for (i = 0; i < size; i++) {
-    a[i] = rand() % max_val;
+  std::vector<int> a;
+  generate(a, size, max_val, dist, seed, threads);
+
+  if (!generate_path.empty()) {
+    std::ofstream out(generate_path, std::ios::binary);
+    out.write(reinterpret_cast<const char *>(a.data()), a.size() * sizeof(int));
+    if (!out) {
+      std::cerr << "ERROR: cannot write " << generate_path << "\n";
+      return 1;
+    }
+    return 0;
+  }
+
+  if (queries.any()) {
+    return run_queries(a, algorithm, threads, queries);
   }
 
 
@@ -239,40 +368,42 @@ int main(int argc, char * argv[]) {
     std::cout << "\n";
   }
 
+  // Opened before the sort so that its threads inherit the counters.
+  std::unique_ptr<PerfCounters> perf;
+  if (counters) perf = std::make_unique<PerfCounters>();
+  reset_alloc_peak();
+  AllocStats alloc_before = alloc_stats();
+  long long rss_before = counters && reset_peak_rss() ? current_rss() : -1;
+
   std::cout << "Starting the sort!\n";
-  struct timeval tp;
-
-  gettimeofday( & tp, NULL);
-  long start_time = tp.tv_sec * 1000 + tp.tv_usec / 1000;
-
-  switch (algorithm) {
-  case 's':
-    a = ssort(a);
-    break;
-  case 'm':
-    a = msort(a);
-    break;
-  case 'q':
-    a = qsort(a);
-    break;
-  case 'r':
-    qsort2(a, 0, a.size()-1);
-    //qsort2(a, 0, a.size() - 1);
-
-    break;
-  }
+  if (perf) perf->start();
+  auto start = std::chrono::steady_clock::now();
 
-  gettimeofday( & tp, NULL);
-  long current_time = tp.tv_sec * 1000 + tp.tv_usec / 1000;
+  if (!run_sort(algorithm, a, threads)) {
+    std::cout << "Unknown algorithm " << algorithm << "\n";
+    return 1;
+  }
 
-  long elapsed = current_time - start_time;
+  std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+  if (perf) perf->stop();
+  AllocStats alloc_after = alloc_stats();
+  long long rss_growth = rss_before >= 0 ? peak_rss() - rss_before : -1;
 
   if (print) {
     print_vector(a);
   }
 
   std::cout << "Algorithm: " << algorithm << "\n";
-  std::cout << "Time: " << elapsed << "\n";
+  if (algorithm == 'a') {
+    std::cout << "Auto picked " << last_auto_choice() << "\n";
+  }
+  std::cout << "Time: " << elapsed.count() << " ms\n";
+  if (last_counts().comparisons >= 0) {
+    std::cout << "Comparisons: " << last_counts().comparisons << "\n";
+  }
+  if (perf) {
+    print_counters(a.size(), alloc_before, alloc_after, rss_growth, perf->read());
+  }
 
   return 0;
 }
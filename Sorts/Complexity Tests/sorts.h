@@ -0,0 +1,36 @@
+#ifndef SORTS_H
+#define SORTS_H
+
+#include <vector>
+#include <string>
+
+
+// From class (sort_modes.cpp). Selection, merge and quick sort live in
+// sortlib.h now; qsort2 stays as the Lomuto baseline.
+void print_vector(const std::vector<int> & vec);
+std::vector<int> makeVec(int n, int max);
+void swap(int * a, int * b);
+int partition(std::vector<int> & arr, int l, int h);
+void qsort2(std::vector<int> & A, int l, int h);
+
+
+// Sorts a with the mode selected by its -a letter. Returns false for an
+// unknown letter.
+bool run_sort(char algorithm, std::vector<int> & a, int threads);
+
+const char * algorithm_name(char algorithm);
+
+// Comparisons and element swaps made by the last run_sort; -1 where that
+// mode doesn't count them. The sortlib modes (s, m, q, T, I) count both, and
+// qsort2 (r) its swaps.
+struct SortCounts {
+  long long comparisons = -1;
+  long long swaps = -1;
+};
+
+SortCounts last_counts();
+
+// The engine -a auto picked last and why, e.g. "radix: key range ...".
+std::string last_auto_choice();
+
+#endif // SORTS_H
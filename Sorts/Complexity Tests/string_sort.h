@@ -0,0 +1,249 @@
+#ifndef STRING_SORT_H
+#define STRING_SORT_H
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <span>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+
+/* Sorts for strings that move views or indices, never characters. The
+   order is std::string_view's: bytes compared as unsigned char, and a
+   prefix sorts before the longer string.
+
+   multikey_quicksort is three-way radix quicksort (Bentley and Sedgewick).
+   It partitions on one byte at a time into <, = and >. Only the = part
+   moves on to the next byte, so it never compares a shared prefix twice.
+
+   string_argsort is MSD radix sort on 8-byte digits. At each depth it
+   caches the next 8 bytes of every string as one big-endian uint64 next
+   to the string's index. The (prefix, index) entries are then sorted by
+   integer compares, so the strings themselves are not read again at that
+   depth. The cached words get LSD byte passes, skipping any byte that is
+   the same everywhere (as in lsd_radix_sort), and each run of equal words
+   that goes on past 8 bytes is sorted again at depth + 8. Long shared
+   prefixes (URLs, paths, ids) cost one pass per 8 bytes, where multikey
+   quicksort pays one partition per byte. Every pass is stable, so equal
+   strings keep their index order. msd_radix_sort applies the permutation
+   to a vector of views. */
+
+const size_t STRING_INSERTION = 16;  // multikey quicksort: insertion sort below this
+const size_t STRING_MSD_SMALL = 32;  // string_argsort: insertion sort below this
+
+
+// Byte depth of s as 1..256, or 0 once s has ended, so shorter sorts first.
+inline int string_char(std::string_view s, size_t depth) {
+  return depth < s.size() ? static_cast<unsigned char>(s[depth]) + 1 : 0;
+}
+
+
+// s from depth on. Strings in a group at depth all have at least depth bytes.
+inline std::string_view string_tail(std::string_view s, size_t depth) {
+  return std::string_view(s.data() + depth, s.size() - depth);
+}
+
+
+// Insertion sort of a[0..n), which share their first depth bytes.
+inline void string_insertion_sort(std::string_view * a, size_t n, size_t depth) {
+  for (size_t i = 1; i < n; i++) {
+    std::string_view x = a[i];
+    size_t j = i;
+    while (j > 0 && string_tail(x, depth) < string_tail(a[j - 1], depth)) {
+      a[j] = a[j - 1];
+      j--;
+    }
+    a[j] = x;
+  }
+}
+
+
+inline void multikey_quicksort(std::string_view * a, size_t n, size_t depth = 0) {
+  while (n > STRING_INSERTION) {
+    int x = string_char(a[0], depth);
+    int y = string_char(a[n / 2], depth);
+    int z = string_char(a[n - 1], depth);
+    int pivot = std::max(std::min(x, y), std::min(std::max(x, y), z));
+
+    // Dijkstra's three-way partition: [0, lt) <, [lt, i) =, [gt, n) >.
+    size_t lt = 0, i = 0, gt = n;
+    while (i < gt) {
+      int c = string_char(a[i], depth);
+      if (c < pivot) {
+        std::swap(a[lt++], a[i++]);
+      } else if (c > pivot) {
+        std::swap(a[i], a[--gt]);
+      } else {
+        i++;
+      }
+    }
+
+    multikey_quicksort(a, lt, depth);
+    multikey_quicksort(a + gt, n - gt, depth);
+
+    // The = part either ended here (all equal) or goes on one byte deeper.
+    if (pivot == 0) return;
+    a += lt;
+    n = gt - lt;
+    depth++;
+  }
+  string_insertion_sort(a, n, depth);
+}
+
+inline void multikey_quicksort(std::vector<std::string_view> & a) {
+  multikey_quicksort(a.data(), a.size());
+}
+
+
+namespace string_sort_detail {
+
+// A string's next 8 bytes from depth, big-endian and zero-padded, and how
+// many bytes it has left there, capped at 9 (9 = more after these 8). The
+// cap tells "ab" from "ab\0", which pad to the same word.
+struct Entry {
+  uint64_t prefix;
+  uint32_t rest;
+  uint32_t index;
+};
+
+inline uint64_t load_prefix(std::string_view s, size_t depth) {
+  size_t left = s.size() - depth;
+  uint64_t x = 0;
+  memcpy(&x, s.data() + depth, std::min<size_t>(left, 8));
+  return __builtin_bswap64(x);
+}
+
+inline bool entry_less(const Entry & x, const Entry & y) {
+  return x.prefix < y.prefix || (x.prefix == y.prefix && x.rest < y.rest);
+}
+
+inline bool entry_equal(const Entry & x, const Entry & y) {
+  return x.prefix == y.prefix && x.rest == y.rest;
+}
+
+// Byte d of an entry's key: d = 0 is rest, 1..8 the prefix from the low end.
+inline unsigned entry_digit(const Entry & e, int d) {
+  return d == 0 ? e.rest : (e.prefix >> ((d - 1) * 8)) & 0xFF;
+}
+
+
+// Stable insertion sort on the cached words. Ties that go on past them
+// compare the rest of the strings.
+inline void insertion_sort(Entry * e, size_t n, const std::string_view * strs, size_t depth) {
+  for (size_t i = 1; i < n; i++) {
+    Entry x = e[i];
+    size_t j = i;
+    while (j > 0) {
+      const Entry & y = e[j - 1];
+      bool less = entry_less(x, y) ||
+                  (entry_equal(x, y) && x.rest > 8 &&
+                   string_tail(strs[x.index], depth + 8) < string_tail(strs[y.index], depth + 8));
+      if (!less) break;
+      e[j] = y;
+      j--;
+    }
+    e[j] = x;
+  }
+}
+
+
+// Sorts e[0..n), strings that share their first depth bytes. scratch holds n.
+inline void msd_sort(Entry * e, size_t n, Entry * scratch, const std::string_view * strs, size_t depth) {
+  const int DIGITS = 9;
+  const int BUCKETS = 256;
+
+  for (size_t i = 0; i < n; i++) {
+    std::string_view s = strs[e[i].index];
+    e[i].prefix = load_prefix(s, depth);
+    e[i].rest = static_cast<uint32_t>(std::min<size_t>(s.size() - depth, 9));
+  }
+
+  if (n < STRING_MSD_SMALL) {
+    insertion_sort(e, n, strs, depth);
+    return;
+  }
+
+  // One read builds the histogram of every digit, as in lsd_radix_sort.
+  std::vector<size_t> counts(DIGITS * BUCKETS, 0);
+  for (size_t i = 0; i < n; i++) {
+    for (int d = 0; d < DIGITS; d++) {
+      counts[d * BUCKETS + entry_digit(e[i], d)]++;
+    }
+  }
+
+  Entry * from = e;
+  Entry * to = scratch;
+  for (int d = 0; d < DIGITS; d++) {
+    size_t * count = &counts[d * BUCKETS];
+
+    // Same byte everywhere: the pass would be a copy.
+    if (count[entry_digit(from[0], d)] == n) continue;
+
+    size_t sum = 0;
+    for (int b = 0; b < BUCKETS; b++) {
+      size_t c = count[b];
+      count[b] = sum;
+      sum += c;
+    }
+    for (size_t i = 0; i < n; i++) {
+      to[count[entry_digit(from[i], d)]++] = from[i];
+    }
+    std::swap(from, to);
+  }
+  if (from != e) {
+    std::copy(from, from + n, e);
+  }
+
+  // Runs of equal words that go on past them are sorted on the next 8 bytes.
+  for (size_t i = 0; i < n;) {
+    size_t j = i + 1;
+    while (j < n && entry_equal(e[j], e[i])) j++;
+    if (j - i > 1 && e[i].rest > 8) {
+      msd_sort(e + i, j - i, scratch, strs, depth + 8);
+    }
+    i = j;
+  }
+}
+
+} // namespace string_sort_detail
+
+
+// perm[i] is the index of the string that belongs at position i of the
+// sorted order. Stable: equal strings keep their index order.
+inline void string_argsort(std::span<const std::string_view> strs, std::vector<uint32_t> & perm) {
+  using string_sort_detail::Entry;
+  size_t n = strs.size();
+  std::vector<Entry> entries(n), scratch(n);
+
+  for (size_t i = 0; i < n; i++) {
+    entries[i].index = static_cast<uint32_t>(i);
+  }
+  string_sort_detail::msd_sort(entries.data(), n, scratch.data(), strs.data(), 0);
+
+  perm.resize(n);
+  for (size_t i = 0; i < n; i++) {
+    perm[i] = entries[i].index;
+  }
+}
+
+// Views of strs are 16 bytes each; the characters stay where they are.
+inline void string_argsort(const std::vector<std::string> & strs, std::vector<uint32_t> & perm) {
+  std::vector<std::string_view> views(strs.begin(), strs.end());
+  string_argsort(views, perm);
+}
+
+
+inline void msd_radix_sort(std::vector<std::string_view> & a) {
+  std::vector<uint32_t> perm;
+  string_argsort(a, perm);
+
+  std::vector<std::string_view> sorted(a.size());
+  for (size_t i = 0; i < a.size(); i++) {
+    sorted[i] = a[perm[i]];
+  }
+  a.swap(sorted);
+}
+
+#endif // STRING_SORT_H
@@ -0,0 +1,155 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+
+/* Work-stealing thread pool.
+   Every thread (the workers plus the one that created the pool) owns a
+   deque. Tasks spawned from a thread go on the back of its own deque and
+   are popped LIFO, so a recursive sort keeps working on hot data; idle
+   threads steal from the front of someone else's deque, which is where the
+   biggest, oldest subproblems sit. */
+
+class ThreadPool {
+public:
+  explicit ThreadPool(int threads) : done_(false), pending_(0) {
+    if (threads < 1) threads = 1;
+
+    for (int i = 0; i < threads; i++) {
+      queues_.emplace_back(new Queue);
+    }
+    // Queue 0 belongs to the calling thread, which helps out in wait().
+    owner_ = this;
+    index_ = 0;
+    for (int i = 1; i < threads; i++) {
+      workers_.emplace_back([this, i] { worker_loop(i); });
+    }
+  }
+
+  ~ThreadPool() {
+    done_ = true;
+    wake_.notify_all();
+    for (auto & t : workers_) {
+      t.join();
+    }
+  }
+
+  int size() const { return queues_.size(); }
+
+  void submit(std::function<void()> task) {
+    int q = self();
+    {
+      std::lock_guard<std::mutex> guard(queues_[q]->lock);
+      queues_[q]->tasks.push_back(std::move(task));
+    }
+    pending_++;
+    wake_.notify_one();
+  }
+
+  // Runs one task from the local deque, or stolen from another one.
+  // Returns false when there was nothing to do.
+  bool run_one() {
+    std::function<void()> task;
+    int q = self();
+
+    if (!pop_back(q, task)) {
+      int n = queues_.size();
+      bool found = false;
+      for (int k = 1; k < n && !found; k++) {
+        found = steal_front((q + k) % n, task);
+      }
+      if (!found) return false;
+    }
+    pending_--;
+    task();
+    return true;
+  }
+
+private:
+  struct Queue {
+    std::deque<std::function<void()>> tasks;
+    std::mutex lock;
+  };
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> workers_;
+  std::atomic<bool> done_;
+  std::atomic<int> pending_;
+  std::mutex sleep_lock_;
+  std::condition_variable wake_;
+
+  static inline thread_local ThreadPool * owner_ = nullptr;
+  static inline thread_local int index_ = 0;
+
+  // Threads that don't belong to this pool share queue 0.
+  int self() const { return owner_ == this ? index_ : 0; }
+
+  bool pop_back(int q, std::function<void()> & task) {
+    std::lock_guard<std::mutex> guard(queues_[q]->lock);
+    if (queues_[q]->tasks.empty()) return false;
+
+    task = std::move(queues_[q]->tasks.back());
+    queues_[q]->tasks.pop_back();
+    return true;
+  }
+
+  bool steal_front(int q, std::function<void()> & task) {
+    std::lock_guard<std::mutex> guard(queues_[q]->lock);
+    if (queues_[q]->tasks.empty()) return false;
+
+    task = std::move(queues_[q]->tasks.front());
+    queues_[q]->tasks.pop_front();
+    return true;
+  }
+
+  void worker_loop(int i) {
+    owner_ = this;
+    index_ = i;
+    while (!done_) {
+      if (run_one()) continue;
+
+      std::unique_lock<std::mutex> guard(sleep_lock_);
+      wake_.wait_for(guard, std::chrono::milliseconds(1),
+                     [this] { return done_ || pending_ > 0; });
+    }
+  }
+};
+
+
+// Fork-join scope on a ThreadPool. wait() keeps running queued tasks
+// instead of blocking, so nested groups never deadlock the pool.
+class TaskGroup {
+public:
+  explicit TaskGroup(ThreadPool & pool) : pool_(pool), outstanding_(0) {}
+
+  ~TaskGroup() { wait(); }
+
+  void run(std::function<void()> task) {
+    outstanding_++;
+    pool_.submit([this, task] {
+      task();
+      outstanding_--;
+    });
+  }
+
+  void wait() {
+    while (outstanding_ > 0) {
+      if (!pool_.run_one()) std::this_thread::yield();
+    }
+  }
+
+private:
+  ThreadPool & pool_;
+  std::atomic<int> outstanding_;
+};
+
+#endif // THREAD_POOL_H